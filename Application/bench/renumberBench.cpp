@@ -0,0 +1,149 @@
+#include "../inc/Comand/factory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+//////////////////////////////////////////////////////////////
+///Renumbering benchmark
+///Runs a ComandFactory::workload session, copies the result with its
+///gates stored in random order and times three traversals on the copy
+///before and after each Document::renumber order:
+///  levelize      gate depths in topological order
+///  sim pass      one xor of the fanin values per gate, in store order
+///  fanout bfs    breadth-first walk from the gates with no fanin
+///Usage: LogicSintesBench [comands] [seed]
+//////////////////////////////////////////////////////////////
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+double msSince( Clock::time_point start ){
+    return std::chrono::duration<double, std::milli>( Clock::now() - start ).count();
+}
+
+// Same gates, ids and edges as `source`, but stored in random order.
+std::shared_ptr<doc::Document> shuffled( const doc::Document& source, unsigned int seed ){
+    std::vector<unsigned int> ids;
+    ids.reserve( source.size() );
+    for( const doc::Gate& gate : source ){
+        ids.push_back( gate.getId() );
+    }
+    std::shuffle( ids.begin(), ids.end(), std::mt19937( seed ) );
+
+    auto copy = std::make_shared<doc::Document>();
+    doc::Gate::Inputs open;
+    open.fill( doc::Gate::NoGate );
+    for( unsigned int id : ids ){
+        copy->addGate( source.typeOf( id ), open, {}, id );
+    }
+    for( unsigned int id : ids ){
+        doc::Gate::Inputs inputs = source.inputsOf( id );
+        doc::Gate::DriverOutputs outputs = source.driverOutputsOf( id );
+        for( unsigned int port = 0; port < doc::Gate::MaxInputs; ++port ){
+            if( inputs[port] != doc::Gate::NoGate ){
+                copy->connect( inputs[port], port, id, outputs[port] );
+            }
+        }
+    }
+    return copy;
+}
+
+void measure( const char* name, const doc::Document& document ){
+    const doc::NetlistStore& store = document.store();
+    unsigned int size = store.size();
+    const unsigned int open = doc::NetlistStore::npos;
+
+    std::vector<unsigned int> level( size, 0 );
+    Clock::time_point start = Clock::now();
+    for( unsigned int id : document.topologicalOrder() ){
+        unsigned int index = document.indexOf( id );
+        unsigned int depth = 0;
+        for( const unsigned int* it = store.faninBegin( index ); it != store.faninEnd( index ); ++it ){
+            if( *it != open ){
+                depth = std::max( depth, level[*it] + 1 );
+            }
+        }
+        level[index] = depth;
+    }
+    double levelize = msSince( start );
+
+    const int passes = 10;
+    std::vector<unsigned char> value( size, 1 );
+    start = Clock::now();
+    for( int pass = 0; pass < passes; ++pass ){
+        for( unsigned int index = 0; index < size; ++index ){
+            unsigned char v = 0;
+            for( const unsigned int* it = store.faninBegin( index ); it != store.faninEnd( index ); ++it ){
+                if( *it != open ){
+                    v ^= value[*it];
+                }
+            }
+            value[index] = v;
+        }
+    }
+    double sim = msSince( start ) / passes;
+
+    std::vector<unsigned char> seen( size, 0 );
+    std::vector<unsigned int> queue;
+    start = Clock::now();
+    for( unsigned int index = 0; index < size; ++index ){
+        if( store.isAlive( index ) && store.faninCaunt( index ) == 0 ){
+            seen[index] = 1;
+            queue.push_back( index );
+        }
+    }
+    for( std::size_t head = 0; head < queue.size(); ++head ){
+        unsigned int index = queue[head];
+        for( unsigned int k = 0; k < store.fanoutCaunt( index ); ++k ){
+            unsigned int sink = store.fanoutAt( index, k );
+            if( !seen[sink] ){
+                seen[sink] = 1;
+                queue.push_back( sink );
+            }
+        }
+    }
+    double bfs = msSince( start );
+
+    // Printed so the passes are not optimized away.
+    unsigned long long check = queue.size();
+    for( unsigned int index = 0; index < size; ++index ){
+        check += level[index] + value[index];
+    }
+    std::printf( "%-14s levelize %8.1f ms   sim pass %7.1f ms   fanout bfs %7.1f ms   (check %llu)\n",
+                 name, levelize, sim, bfs, check );
+}
+
+void renumbered( doc::Document& document, doc::GateOrder order, const char* name ){
+    Clock::time_point start = Clock::now();
+    document.renumber( order );
+    std::printf( "renumber %-14s %.0f ms\n", name, msSince( start ) );
+    measure( name, document );
+}
+
+} // namespace
+
+int main( int argc, char* argv[] ){
+    std::size_t caunt = argc > 1 ? std::strtoull( argv[1], nullptr, 10 ) : 5000000;
+    unsigned int seed = argc > 2 ? static_cast<unsigned int>( std::strtoul( argv[2], nullptr, 10 ) ) : 1;
+
+    com::ComandFactory factory;
+    doc::Document edited;
+    Clock::time_point start = Clock::now();
+    factory.workload( caunt, seed ).run( edited, com::ComandStream::OnError::Skip );
+    std::printf( "workload of %zu comands, seed %u: %u gates in %.0f ms\n", caunt, seed, edited.size(), msSince( start ) );
+    measure( "as edited", edited );
+
+    std::shared_ptr<doc::Document> document = shuffled( edited, seed );
+    measure( "shuffled", *document );
+    renumbered( *document, doc::GateOrder::DepthFirst, "depth first" );
+    renumbered( *document, doc::GateOrder::Topological, "topological" );
+    renumbered( *document, doc::GateOrder::CuthillMcKee, "cuthill-mckee" );
+    return 0;
+}
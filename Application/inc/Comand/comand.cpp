@@ -0,0 +1,261 @@
+#include "comand.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace com
+{
+
+namespace
+{
+const doc::Gate::Inputs NoInputs = []{
+    doc::Gate::Inputs inputs;
+    inputs.fill(doc::Gate::NoGate);
+    return inputs;
+}();
+
+// Low two bits of the first byte; the rest holds the type or the port.
+const unsigned int OpBits = 2;
+}
+
+
+
+AddGate::AddGate(doc::Document& doc, doc::GateType type)
+    : doc_(doc), type_(type)
+{
+}
+
+void AddGate::execute(){
+    gateId_ = doc_.addGate(type_, NoInputs);
+}
+
+unsigned int AddGate::gateId() const{
+    return gateId_;
+}
+
+RemoveGate::RemoveGate(doc::Document& doc, unsigned int gateId)
+    : doc_(doc), gateId_(gateId)
+{
+}
+
+void RemoveGate::execute(){
+    doc_.removeaGate(gateId_);
+}
+
+AddEdge::AddEdge(doc::Document& doc, unsigned int driverId, unsigned int port, unsigned int sinkId)
+    : doc_(doc), driverId_(driverId), port_(port), sinkId_(sinkId)
+{
+}
+
+void AddEdge::execute(){
+    doc_.connect(driverId_, port_, sinkId_);
+}
+
+RemoveEdge::RemoveEdge(doc::Document& doc, unsigned int port, unsigned int sinkId)
+    : doc_(doc), port_(port), sinkId_(sinkId)
+{
+}
+
+void RemoveEdge::execute(){
+    doc_.disconnect(port_, sinkId_);
+}
+
+
+
+ComandStream::Reader::Reader(const ComandStream& stream)
+    : at_(stream.bytes_.data()), end_(stream.bytes_.data() + stream.bytes_.size())
+{
+}
+
+bool ComandStream::Reader::next(Entry& entry){
+    if(at_ == end_){
+        return false;
+    }
+    unsigned int head = *at_++;
+    entry.op = static_cast<Op>(head & ((1u << OpBits) - 1));
+    entry.type = doc::GateType::INPUT;
+    entry.port = 0;
+    entry.gate = 0;
+    entry.driver = 0;
+    switch(entry.op){
+    case Op::AddGate:
+        entry.type = static_cast<doc::GateType>(head >> OpBits);
+        entry.gate = gateCaunt_++;
+        break;
+    case Op::RemoveGate:
+        entry.gate = gateBack(gateCaunt_);
+        break;
+    case Op::AddEdge:
+        entry.port = head >> OpBits;
+        entry.driver = gateBack(gateCaunt_);
+        entry.gate = gateBack(gateCaunt_);
+        break;
+    case Op::RemoveEdge:
+        entry.port = head >> OpBits;
+        entry.gate = gateBack(gateCaunt_);
+        break;
+    }
+    return true;
+}
+
+// Streams are checked as they are built, so the bytes are well formed.
+unsigned int ComandStream::Reader::gateBack(unsigned int number){
+    unsigned int back = 0;
+    for(unsigned int shift = 0; ; shift += 7){
+        unsigned int byte = *at_++;
+        back |= (byte & 0x7f) << shift;
+        if(byte < 0x80){
+            break;
+        }
+    }
+    return number - 1 - back;
+}
+
+unsigned int ComandStream::addGate(doc::GateType type){
+    if(static_cast<unsigned int>(type) >= doc::GateTypeCaunt){
+        throw std::out_of_range("ComandStream: bad gate type");
+    }
+    bytes_.push_back(static_cast<unsigned char>((static_cast<unsigned int>(type) << OpBits) | static_cast<unsigned int>(Op::AddGate)));
+    ++size_;
+    return gateCaunt_++;
+}
+
+void ComandStream::removeGate(unsigned int gate){
+    if(gate >= gateCaunt_){
+        throw std::out_of_range("ComandStream: no gate " + std::to_string(gate));
+    }
+    bytes_.push_back(static_cast<unsigned char>(Op::RemoveGate));
+    putGate(gate);
+    ++size_;
+}
+
+void ComandStream::addEdge(unsigned int driver, unsigned int port, unsigned int sink){
+    if(driver >= gateCaunt_ || sink >= gateCaunt_){
+        throw std::out_of_range("ComandStream: no gate " + std::to_string(driver >= gateCaunt_ ? driver : sink));
+    }
+    if(port >= doc::MaxGateInputs){
+        throw std::out_of_range("ComandStream: gate port out of range");
+    }
+    bytes_.push_back(static_cast<unsigned char>((port << OpBits) | static_cast<unsigned int>(Op::AddEdge)));
+    putGate(driver);
+    putGate(sink);
+    ++size_;
+}
+
+void ComandStream::removeEdge(unsigned int port, unsigned int sink){
+    if(sink >= gateCaunt_){
+        throw std::out_of_range("ComandStream: no gate " + std::to_string(sink));
+    }
+    if(port >= doc::MaxGateInputs){
+        throw std::out_of_range("ComandStream: gate port out of range");
+    }
+    bytes_.push_back(static_cast<unsigned char>((port << OpBits) | static_cast<unsigned int>(Op::RemoveEdge)));
+    putGate(sink);
+    ++size_;
+}
+
+void ComandStream::append(const Entry& entry){
+    switch(entry.op){
+    case Op::AddGate:
+        addGate(entry.type);
+        break;
+    case Op::RemoveGate:
+        removeGate(entry.gate);
+        break;
+    case Op::AddEdge:
+        addEdge(entry.driver, entry.port, entry.gate);
+        break;
+    case Op::RemoveEdge:
+        removeEdge(entry.port, entry.gate);
+        break;
+    default:
+        throw std::invalid_argument("ComandStream: unknown comand");
+    }
+}
+
+void ComandStream::clear(){
+    bytes_.clear();
+    size_ = 0;
+    gateCaunt_ = 0;
+}
+
+std::size_t ComandStream::size() const{
+    return size_;
+}
+
+unsigned int ComandStream::gateCaunt() const{
+    return gateCaunt_;
+}
+
+const std::vector<unsigned char> &ComandStream::bytes() const{
+    return bytes_;
+}
+
+std::size_t ComandStream::run(doc::Document& doc, OnError onError) const{
+    // Document id of every gate number; NoGate if its AddGate failed.
+    std::vector<unsigned int> ids;
+    ids.reserve(gateCaunt_);
+    std::size_t applied = 0;
+    doc::ChangeJournal::Batch batch(doc.journal());
+    Reader reader(*this);
+    Entry entry;
+    while(reader.next(entry)){
+        try{
+            switch(entry.op){
+            case Op::AddGate:
+                ids.push_back(doc::Gate::NoGate);
+                ids.back() = doc.addGate(entry.type, NoInputs);
+                break;
+            case Op::RemoveGate:
+                doc.removeaGate(ids[entry.gate]);
+                break;
+            case Op::AddEdge:
+                doc.connect(ids[entry.driver], entry.port, ids[entry.gate]);
+                break;
+            case Op::RemoveEdge:
+                doc.disconnect(entry.port, ids[entry.gate]);
+                break;
+            }
+        }catch(const doc::CycleError&){
+            if(onError == OnError::Stop){
+                throw;
+            }
+            continue;
+        }catch(const std::logic_error&){
+            if(onError == OnError::Stop){
+                throw;
+            }
+            continue;
+        }
+        ++applied;
+    }
+    return applied;
+}
+
+// Counted back from the newest gate, recent gates take one byte.
+void ComandStream::putGate(unsigned int gate){
+    unsigned int back = gateCaunt_ - 1 - gate;
+    while(back >= 0x80){
+        bytes_.push_back(static_cast<unsigned char>(back | 0x80));
+        back >>= 7;
+    }
+    bytes_.push_back(static_cast<unsigned char>(back));
+}
+
+
+
+RunStream::RunStream(doc::Document& doc, ComandStream stream, ComandStream::OnError onError)
+    : doc_(doc), stream_(std::move(stream)), onError_(onError)
+{
+}
+
+void RunStream::execute(){
+    applied_ = stream_.run(doc_, onError_);
+}
+
+std::size_t RunStream::applied() const{
+    return applied_;
+}
+
+
+} // namespace com
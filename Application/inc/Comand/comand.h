@@ -1,37 +1,156 @@
 #pragma once
 
+#include "../Document/document.h"
+
+#include <cstddef>
+#include <vector>
 
 namespace com
 {
-    
-    
+
+
 class IComand{
 public:
     virtual ~IComand() = default;
     virtual void execute() = 0;
 };
-    
+
 
 
 class AddGate  : public IComand
 {
+public:
+    AddGate( doc::Document& doc, doc::GateType type );
+    void execute() override;
+    // Id of the added gate once executed.
+    unsigned int gateId() const;
 
+private:
+    doc::Document& doc_;
+    doc::GateType type_;
+    unsigned int gateId_ = doc::Gate::NoGate;
 };
 
 class RemoveGate : public IComand
 {
+public:
+    RemoveGate( doc::Document& doc, unsigned int gateId );
+    void execute() override;
 
+private:
+    doc::Document& doc_;
+    unsigned int gateId_;
 };
 
 
 class AddEdge : public IComand
 {
+public:
+    AddEdge( doc::Document& doc, unsigned int driverId, unsigned int port, unsigned int sinkId );
+    void execute() override;
 
+private:
+    doc::Document& doc_;
+    unsigned int driverId_;
+    unsigned int port_;
+    unsigned int sinkId_;
 };
 
 class RemoveEdge : public IComand
 {
-    
+public:
+    RemoveEdge( doc::Document& doc, unsigned int port, unsigned int sinkId );
+    void execute() override;
+
+private:
+    doc::Document& doc_;
+    unsigned int port_;
+    unsigned int sinkId_;
+};
+
+
+
+//////////////////////////////////////////////////////////////
+///Comand stream
+///The same four comands, encoded back to back for bulk edits, replays
+///and benchmark workloads. A stream does not know gate ids ahead of
+///time: the n-th AddGate of a stream makes gate n, and comands name
+///gates by that number. Encoded, a comand is one byte holding its kind
+///and its gate type or port, then its gates as varints counted back
+///from the newest gate, so most comands take two to four bytes.
+//////////////////////////////////////////////////////////////
+class ComandStream{
+public:
+    enum class Op : unsigned char { AddGate, RemoveGate, AddEdge, RemoveEdge };
+
+    // One decoded comand; fields the op does not use are 0.
+    struct Entry
+    {
+        Op op = Op::AddGate;
+        doc::GateType type = doc::GateType::INPUT;
+        unsigned int port = 0;
+        // Gate number: the removed gate or the sink of an edge.
+        unsigned int gate = 0;
+        unsigned int driver = 0;
+    };
+
+    class Reader{
+    public:
+        explicit Reader( const ComandStream& stream );
+        // False past the last comand.
+        bool next( Entry& entry );
+    private:
+        unsigned int gateBack( unsigned int number );
+    private:
+        const unsigned char* at_;
+        const unsigned char* end_;
+        unsigned int gateCaunt_ = 0;
+    };
+
+    // What run() does with a comand the document rejects, e.g. an edge
+    // closing a cycle or one naming a removed gate.
+    enum class OnError { Stop, Skip };
+
+public:
+    // Returns the number of the new gate.
+    unsigned int addGate( doc::GateType type );
+    void removeGate( unsigned int gate );
+    void addEdge( unsigned int driver, unsigned int port, unsigned int sink );
+    void removeEdge( unsigned int port, unsigned int sink );
+    void append( const Entry& entry );
+    void clear();
+
+    std::size_t size() const;
+    unsigned int gateCaunt() const;
+    const std::vector<unsigned char>& bytes() const;
+
+    // Applies the comands to `doc` in one journal batch. Stop rethrows
+    // the error and keeps what was applied before it; Skip leaves the
+    // rejected comand out. Returns the caunt applied.
+    std::size_t run( doc::Document& doc, OnError onError = OnError::Stop ) const;
+
+private:
+    void putGate( unsigned int gate );
+
+private:
+    std::vector<unsigned char> bytes_;
+    std::size_t size_ = 0;
+    unsigned int gateCaunt_ = 0;
+};
+
+// Runs a stream as one comand.
+class RunStream : public IComand
+{
+public:
+    RunStream( doc::Document& doc, ComandStream stream, ComandStream::OnError onError = ComandStream::OnError::Stop );
+    void execute() override;
+    std::size_t applied() const;
+
+private:
+    doc::Document& doc_;
+    ComandStream stream_;
+    ComandStream::OnError onError_;
+    std::size_t applied_ = 0;
 };
 
-} // namespace com
\ No newline at end of file
+} // namespace com
@@ -0,0 +1,313 @@
+#include "factory.h"
+
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace com
+{
+
+namespace
+{
+const char Magic[8] = { 'L', 'S', 'C', 'O', 'M', 'A', 'N', '1' };
+
+class TextParser
+{
+public:
+    explicit TextParser( const std::string& text )
+        : at_( text.data() ), end_( text.data() + text.size() )
+    {
+    }
+
+    // False at the end of the text; skips blank and comment lines.
+    bool nextLine()
+    {
+        while( at_ != end_ ){
+            skipSpace();
+            if( at_ != end_ && *at_ != '\n' && *at_ != '#' ){
+                return true;
+            }
+            skipLine();
+        }
+        return false;
+    }
+
+    char word()
+    {
+        const char* start = at_;
+        while( at_ != end_ && !isSpace( *at_ ) && *at_ != '\n' ){
+            ++at_;
+        }
+        if( at_ - start != 1 ){
+            fail( "unknown comand" );
+        }
+        skipSpace();
+        return *start;
+    }
+
+    unsigned int number()
+    {
+        if( at_ == end_ || *at_ < '0' || *at_ > '9' ){
+            fail( "number expected" );
+        }
+        unsigned long long value = 0;
+        while( at_ != end_ && *at_ >= '0' && *at_ <= '9' ){
+            value = value * 10 + static_cast<unsigned int>( *at_ - '0' );
+            if( value > 0xffffffffu ){
+                fail( "number out of range" );
+            }
+            ++at_;
+        }
+        skipSpace();
+        return static_cast<unsigned int>( value );
+    }
+
+    doc::GateType gateType()
+    {
+        const char* start = at_;
+        while( at_ != end_ && !isSpace( *at_ ) && *at_ != '\n' && *at_ != '#' ){
+            ++at_;
+        }
+        name_.assign( start, at_ );
+        skipSpace();
+        try{
+            return doc::gateTypeFromName( name_ );
+        }catch( const std::invalid_argument& ){
+            fail( "unknown gate type " + name_ );
+        }
+        return doc::GateType::INPUT;
+    }
+
+    void endLine()
+    {
+        if( at_ != end_ && *at_ != '\n' && *at_ != '#' ){
+            fail( "unexpected text after the comand" );
+        }
+        skipLine();
+    }
+
+    [[noreturn]] void fail( const std::string& what ) const
+    {
+        throw std::runtime_error( "ComandFactory: line " + std::to_string( line_ ) + ": " + what );
+    }
+
+private:
+    static bool isSpace( char c )
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    void skipSpace()
+    {
+        while( at_ != end_ && isSpace( *at_ ) ){
+            ++at_;
+        }
+    }
+
+    void skipLine()
+    {
+        while( at_ != end_ && *at_ != '\n' ){
+            ++at_;
+        }
+        if( at_ != end_ ){
+            ++at_;
+            ++line_;
+        }
+    }
+
+private:
+    const char* at_;
+    const char* end_;
+    std::size_t line_ = 1;
+    std::string name_;
+};
+
+unsigned int readBack( const unsigned char*& at, const unsigned char* end )
+{
+    unsigned int back = 0;
+    for( unsigned int shift = 0; shift < 35; shift += 7 ){
+        if( at == end ){
+            throw std::runtime_error( "ComandFactory: stream ends inside a comand" );
+        }
+        unsigned int byte = *at++;
+        back |= ( byte & 0x7f ) << shift;
+        if( byte < 0x80 ){
+            return back;
+        }
+    }
+    throw std::runtime_error( "ComandFactory: bad value" );
+}
+
+unsigned int gateBack( const unsigned char*& at, const unsigned char* end, unsigned int gateCaunt )
+{
+    unsigned int back = readBack( at, end );
+    if( back >= gateCaunt ){
+        throw std::runtime_error( "ComandFactory: comand names a gate before the stream" );
+    }
+    return gateCaunt - 1 - back;
+}
+}
+
+
+
+ComandStream ComandFactory::fromText(std::istream &in){
+    std::string text( ( std::istreambuf_iterator<char>( in ) ), std::istreambuf_iterator<char>() );
+    TextParser parser( text );
+    ComandStream stream;
+    ComandStream::Entry entry;
+    while( parser.nextLine() ){
+        switch( parser.word() ){
+        case 'g':
+            entry.op = ComandStream::Op::AddGate;
+            entry.type = parser.gateType();
+            break;
+        case 'r':
+            entry.op = ComandStream::Op::RemoveGate;
+            entry.gate = parser.number();
+            break;
+        case 'e':
+            entry.op = ComandStream::Op::AddEdge;
+            entry.driver = parser.number();
+            entry.port = parser.number();
+            entry.gate = parser.number();
+            break;
+        case 'd':
+            entry.op = ComandStream::Op::RemoveEdge;
+            entry.port = parser.number();
+            entry.gate = parser.number();
+            break;
+        default:
+            parser.fail( "unknown comand" );
+        }
+        try{
+            stream.append( entry );
+        }catch( const std::logic_error& error ){
+            parser.fail( error.what() );
+        }
+        parser.endLine();
+    }
+    return stream;
+}
+
+ComandStream ComandFactory::fromBinary(std::istream &in){
+    char magic[sizeof( Magic )];
+    if( !in.read( magic, sizeof( magic ) ) || std::memcmp( magic, Magic, sizeof( Magic ) ) != 0 ){
+        throw std::runtime_error( "ComandFactory: not a comand stream" );
+    }
+    std::vector<unsigned char> bytes( ( std::istreambuf_iterator<char>( in ) ), std::istreambuf_iterator<char>() );
+    const unsigned char* at = bytes.data();
+    const unsigned char* end = bytes.data() + bytes.size();
+    ComandStream stream;
+    ComandStream::Entry entry;
+    while( at != end ){
+        entry = ComandStream::Entry();
+        unsigned int head = *at++;
+        entry.op = static_cast<ComandStream::Op>( head & 3u );
+        switch( entry.op ){
+        case ComandStream::Op::AddGate:
+            if( ( head >> 2 ) >= doc::GateTypeCaunt ){
+                throw std::runtime_error( "ComandFactory: bad gate type" );
+            }
+            entry.type = static_cast<doc::GateType>( head >> 2 );
+            break;
+        case ComandStream::Op::RemoveGate:
+            entry.gate = gateBack( at, end, stream.gateCaunt() );
+            break;
+        case ComandStream::Op::AddEdge:
+            entry.port = head >> 2;
+            entry.driver = gateBack( at, end, stream.gateCaunt() );
+            entry.gate = gateBack( at, end, stream.gateCaunt() );
+            break;
+        case ComandStream::Op::RemoveEdge:
+            entry.port = head >> 2;
+            entry.gate = gateBack( at, end, stream.gateCaunt() );
+            break;
+        }
+        if( entry.port >= doc::MaxGateInputs ){
+            throw std::runtime_error( "ComandFactory: bad port" );
+        }
+        stream.append( entry );
+    }
+    return stream;
+}
+
+void ComandFactory::toText(const ComandStream &stream, std::ostream &out){
+    std::string text;
+    ComandStream::Reader reader( stream );
+    ComandStream::Entry entry;
+    while( reader.next( entry ) ){
+        switch( entry.op ){
+        case ComandStream::Op::AddGate:
+            text += "g ";
+            text += doc::descriptor( entry.type ).name;
+            break;
+        case ComandStream::Op::RemoveGate:
+            text += "r ";
+            text += std::to_string( entry.gate );
+            break;
+        case ComandStream::Op::AddEdge:
+            text += "e ";
+            text += std::to_string( entry.driver );
+            text += ' ';
+            text += std::to_string( entry.port );
+            text += ' ';
+            text += std::to_string( entry.gate );
+            break;
+        case ComandStream::Op::RemoveEdge:
+            text += "d ";
+            text += std::to_string( entry.port );
+            text += ' ';
+            text += std::to_string( entry.gate );
+            break;
+        }
+        text += '\n';
+    }
+    out.write( text.data(), static_cast<std::streamsize>( text.size() ) );
+}
+
+void ComandFactory::toBinary(const ComandStream &stream, std::ostream &out){
+    out.write( Magic, sizeof( Magic ) );
+    out.write( reinterpret_cast<const char*>( stream.bytes().data() ), static_cast<std::streamsize>( stream.bytes().size() ) );
+}
+
+// mt19937 output is fixed by the standard; the distributions are not,
+// so values are drawn by plain modulo.
+ComandStream ComandFactory::workload(std::size_t caunt, unsigned int seed){
+    std::mt19937 random( seed );
+    ComandStream stream;
+    // Live gate numbers and the type of every gate number.
+    std::vector<unsigned int> live;
+    std::vector<doc::GateType> types;
+    while( stream.size() < caunt ){
+        unsigned int roll = random() % 100;
+        if( roll < 40 || live.size() < 2 ){
+            doc::GateType type = random() % 10 == 0 ? doc::GateType::INPUT
+                                                     : static_cast<doc::GateType>( 2 + random() % ( doc::GateTypeCaunt - 2 ) );
+            live.push_back( stream.addGate( type ) );
+            types.push_back( type );
+            continue;
+        }
+        unsigned int sink = live[random() % live.size()];
+        unsigned int inputCaunt = doc::descriptor( types[sink] ).inputCaunt;
+        if( roll < 90 && inputCaunt > 0 ){
+            unsigned int driver = live[random() % live.size()];
+            if( roll < 75 && driver < sink ){
+                stream.addEdge( driver, random() % inputCaunt, sink );
+            }else if( roll >= 75 ){
+                stream.removeEdge( random() % inputCaunt, sink );
+            }
+        }else if( roll >= 90 ){
+            std::size_t at = random() % live.size();
+            stream.removeGate( live[at] );
+            live[at] = live.back();
+            live.pop_back();
+        }
+    }
+    return stream;
+}
+
+
+} // namespace com
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "comand.h"
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+
+namespace com
+{
+
+
+
+//////////////////////////////////////////////////////////////
+///Comand factory
+///Reads and writes comand streams. The text form is one comand per
+///line, gates named by their stream number; '#' starts a comment:
+///  g AND_2        add a gate
+///  r 3            remove gate 3
+///  e 0 1 3        edge from gate 0 into port 1 of gate 3
+///  d 1 3          disconnect port 1 of gate 3
+///The binary form is a magic word followed by the encoded stream.
+//////////////////////////////////////////////////////////////
+class ComandFactory{
+public:
+    ComandStream fromText( std::istream& in );
+    ComandStream fromBinary( std::istream& in );
+    void toText( const ComandStream& stream, std::ostream& out );
+    void toBinary( const ComandStream& stream, std::ostream& out );
+
+    // A random edit session of `caunt` comands, the same for the same
+    // seed on every platform. Edges run from older to newer gates, so
+    // none closes a cycle.
+    ComandStream workload( std::size_t caunt, unsigned int seed );
+};
+
+
+} // namespace com
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace doc
+{
+
+//////////////////////////////////////////////////////////////
+///Arena
+///Per-document pool behind the chunks of its CowVectors and its other
+///small nodes. Blocks of one size are cut from 256 KiB slabs and
+///recycled through a free list; slabs go back to the system only when
+///the arena dies, one free per slab. Chunks still shared with a
+///snapshot keep the arena alive and may be dropped on another thread,
+///hence the lock.
+///A mapped arena takes its slabs from a scratch file instead, mapped
+///in 64 MiB segments: the kernel pages chunks in on demand and writes
+///dirty ones back, so a design may be larger than memory. Chunks are
+///cut in allocation order, and a bulk-loaded store grows all of its
+///arrays in step, so an index-order scan reads the file front to back.
+//////////////////////////////////////////////////////////////
+class Arena : public std::pmr::memory_resource
+{
+public:
+    static constexpr std::size_t SlabBytes = 256 * 1024;
+    // Bigger blocks bypass the slabs.
+    static constexpr std::size_t MaxBlockBytes = SlabBytes / 8;
+    static constexpr std::size_t SegmentBytes = 256 * SlabBytes;
+
+public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena() override;
+
+    // File-backed arena. The file at path is created (or truncated) and
+    // unlinked at once, so nothing is left behind. Throws
+    // std::runtime_error if it cannot be created or mapped.
+    static std::shared_ptr<Arena> mapped(const std::string& path);
+
+    unsigned int slabCaunt() const;
+    bool isMapped() const;
+    // Writes dirty pages of a mapped arena back to its file; no-op otherwise.
+    void flush();
+    // Tells the kernel the mapped chunks will be read front to back.
+    void adviseSequential();
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* block, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    struct Pool
+    {
+        std::size_t blockSize;
+        void* free;
+    };
+
+    static std::size_t blockSize(std::size_t bytes);
+    Pool& pool(std::size_t size);
+    char* newSlab();
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Pool> pools_;
+    std::vector<void*> slabs_;
+    // Mapped arena only: the file and its segments.
+    int file_ = -1;
+    std::vector<char*> segments_;
+    std::size_t segmentUsed_ = SegmentBytes;
+};
+
+// Standard allocator over an arena that it keeps alive, for memory that
+// may outlive the document (chunks shared with snapshots).
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(std::shared_ptr<Arena> arena) : arena_(std::move(arena)) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* block, std::size_t n)
+    {
+        arena_->deallocate(block, n * sizeof(T), alignof(T));
+    }
+
+    const std::shared_ptr<Arena>& arena() const { return arena_; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.arena(); }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena_ != other.arena(); }
+
+private:
+    std::shared_ptr<Arena> arena_;
+};
+
+} // namespace doc
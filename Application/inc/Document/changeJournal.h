@@ -0,0 +1,91 @@
+#pragma once
+#include <functional>
+#include <utility>
+#include <vector>
+#include "gateType.h"
+
+namespace doc
+{
+
+// One structural edit of a document. Edge changes name the sink gate in
+// `gate` and the driving gate in `driver`, and which output of it in
+// `output`.
+struct Change
+{
+    enum Kind : unsigned char
+    {
+        GateAdded,
+        GateRemoved,
+        EdgeAdded,
+        EdgeRemoved,
+        TypeChanged,
+        InstanceAdded,      // `gate` is the instance id
+        InstanceRemoved,
+        InstanceBound       // input `port` of instance `gate` now reads `driver`, its `output`
+    };
+
+    Kind kind;
+    GateType type;      // current type of `gate`; for GateRemoved the type it had
+    GateType oldType;   // TypeChanged only
+    unsigned char port;
+    unsigned int gate;
+    unsigned int driver;
+    unsigned char output = 0;
+};
+
+using ChangeBatch = std::vector<Change>;
+
+//////////////////////////////////////////////////////////////
+///Change journal
+///Collects the changes a document makes and hands them to the
+///subscribers in batches. Changes recorded outside of a batch are
+///published one by one; between beginBatch() and the matching
+///endBatch() they are queued and published together at the end.
+///Batches nest, only the outermost one publishes.
+//////////////////////////////////////////////////////////////
+class ChangeJournal
+{
+public:
+    using Subscriber = std::function<void(const ChangeBatch&)>;
+
+    // Scoped batch: begins on construction and ends on destruction.
+    class Batch
+    {
+    public:
+        explicit Batch(ChangeJournal& journal);
+        ~Batch();
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+    private:
+        ChangeJournal& journal_;
+    };
+
+public:
+    // Returns a handle for unsubscribe(). A subscriber handles its own
+    // errors; a std::exception it throws anyway is logged and the other
+    // subscribers still get the batch. Subscribing and unsubscribing
+    // from inside a subscriber take effect after the batch.
+    unsigned int subscribe(Subscriber subscriber);
+    void unsubscribe(unsigned int handle);
+
+    void record(const Change& change);
+    void beginBatch();
+    void endBatch();
+    bool inBatch() const;
+
+private:
+    void publish();
+    void settleSubscribers();
+
+private:
+    std::vector<std::pair<unsigned int, Subscriber>> subscribers_;
+    // Subscribed while a batch is delivered.
+    std::vector<std::pair<unsigned int, Subscriber>> added_;
+    ChangeBatch pending_;
+    unsigned int depth_ = 0;
+    unsigned int nextHandle_ = 1;
+    bool publishing_ = false;
+};
+
+} // namespace doc
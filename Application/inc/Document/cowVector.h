@@ -0,0 +1,302 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "arena.h"
+
+namespace doc
+{
+
+//////////////////////////////////////////////////////////////
+///Copy-on-write chunked vector
+///Elements live in fixed-size chunks reached through a shared chunk
+///table. Copying the vector shares the table, so it costs O(1); the
+///first write after a copy clones the table (chunk pointers only) and
+///every write clones just the chunk it touches if that chunk is still
+///shared. Only the owner of the original may write while copies are
+///read on other threads. With an arena set, new chunks come from it.
+//////////////////////////////////////////////////////////////
+template <typename T, unsigned int ChunkBits = 10>
+class CowVector
+{
+public:
+    static constexpr unsigned int ChunkSize = 1u << ChunkBits;
+    static constexpr unsigned int ChunkMask = ChunkSize - 1;
+
+public:
+    CowVector() : table_(std::make_shared<Table>()) {}
+    explicit CowVector(std::shared_ptr<Arena> arena) : arena_(std::move(arena)), table_(newTable()) {}
+    CowVector(const CowVector&) = default;
+    CowVector(CowVector&&) = default;
+
+    // Replacing the contents lets go of them like a write does.
+    CowVector& operator=(const CowVector& other)
+    {
+        if(this != &other)
+        {
+            detached_ += droppedBytes();
+            arena_ = other.arena_;
+            table_ = other.table_;
+        }
+        return *this;
+    }
+
+    CowVector& operator=(CowVector&& other) noexcept
+    {
+        if(this != &other)
+        {
+            detached_ += droppedBytes();
+            arena_ = std::move(other.arena_);
+            table_ = std::move(other.table_);
+        }
+        return *this;
+    }
+
+    // Only chunks allocated from now on come from the arena.
+    void setArena(std::shared_ptr<Arena> arena)
+    {
+        arena_ = std::move(arena);
+    }
+
+    const std::shared_ptr<Arena>& arena() const
+    {
+        return arena_;
+    }
+
+    unsigned int size() const { return table_->size; }
+    bool empty() const { return table_->size == 0; }
+
+    const T& operator[](unsigned int i) const
+    {
+        return (*table_->chunks[i >> ChunkBits])[i & ChunkMask];
+    }
+
+    const T& back() const
+    {
+        return (*this)[size() - 1];
+    }
+
+    // Writable element; clones the table and the chunk if they are shared.
+    T& mut(unsigned int i)
+    {
+        return (*writableChunk(i >> ChunkBits))[i & ChunkMask];
+    }
+
+    void set(unsigned int i, const T& value)
+    {
+        mut(i) = value;
+    }
+
+    // Elements from i up to the end of its chunk are contiguous.
+    const T* ptr(unsigned int i) const
+    {
+        return table_->chunks[i >> ChunkBits]->data() + (i & ChunkMask);
+    }
+
+    T* mutPtr(unsigned int i)
+    {
+        return &mut(i);
+    }
+
+    // Free slots left in the last chunk before a new one is started.
+    unsigned int roomInChunk() const
+    {
+        return ChunkSize - (size() & ChunkMask);
+    }
+
+    void push_back(const T& value)
+    {
+        resize(size() + 1, value);
+    }
+
+    void pop_back()
+    {
+        resize(size() - 1);
+    }
+
+    void append(unsigned int caunt, const T& value)
+    {
+        resize(size() + caunt, value);
+    }
+
+    void resize(unsigned int newSize, const T& value = T())
+    {
+        Table& table = writableTable();
+        unsigned int oldSize = table.size;
+        unsigned int chunks = (newSize + ChunkMask) >> ChunkBits;
+        if(newSize < oldSize)
+        {
+            for(std::size_t chunk = chunks; chunk < table.chunks.size(); ++chunk)
+            {
+                if(table.chunks[chunk].use_count() > 1)
+                {
+                    detached_ += sizeof(Chunk);
+                }
+            }
+            table.chunks.resize(chunks);
+            table.size = newSize;
+            return;
+        }
+        while(table.chunks.size() < chunks)
+        {
+            table.chunks.push_back(newChunk());
+        }
+        table.size = newSize;
+        for(unsigned int i = oldSize; i < newSize; )
+        {
+            unsigned int end = std::min(newSize, (i | ChunkMask) + 1);
+            T* first = writableChunk(i >> ChunkBits)->data() + (i & ChunkMask);
+            std::fill(first, first + (end - i), value);
+            i = end;
+        }
+    }
+
+    void reserve(unsigned int caunt)
+    {
+        writableTable().chunks.reserve((caunt + ChunkMask) >> ChunkBits);
+    }
+
+    void clear()
+    {
+        detached_ += droppedBytes();
+        table_ = newTable();
+    }
+
+    // True when this vector and other still share every chunk.
+    bool sharesWith(const CowVector& other) const
+    {
+        return table_ == other.table_;
+    }
+
+    // Memory this vector holds that `other` does not share: its own
+    // table and the chunks that differ at the same position.
+    std::size_t bytesApartFrom(const CowVector& other) const
+    {
+        if(sharesWith(other))
+        {
+            return 0;
+        }
+        const std::vector<std::shared_ptr<Chunk>>& chunks = table_->chunks;
+        const std::vector<std::shared_ptr<Chunk>>& others = other.table_->chunks;
+        std::size_t bytes = sizeof(Table) + chunks.capacity() * sizeof(std::shared_ptr<Chunk>);
+        for(std::size_t chunk = 0; chunk < chunks.size(); ++chunk)
+        {
+            if(chunk >= others.size() || chunks[chunk] != others[chunk])
+            {
+                bytes += sizeof(Chunk);
+            }
+        }
+        return bytes;
+    }
+
+    // Memory the vector let go of while a copy still shared it: tables
+    // and chunks cloned on write, dropped or replaced. A copy keeps at
+    // most what the vector detached since the copy was taken apart from
+    // it, without a walk over the chunks.
+    std::size_t detachedBytes() const
+    {
+        return detached_;
+    }
+
+private:
+    using Chunk = std::array<T, ChunkSize>;
+
+    struct Table
+    {
+        std::vector<std::shared_ptr<Chunk>> chunks;
+        unsigned int size = 0;
+    };
+
+    Table& writableTable()
+    {
+        if(!owned(table_))
+        {
+            detached_ += tableBytes();
+            table_ = newTable(*table_);
+        }
+        return *table_;
+    }
+
+    Chunk* writableChunk(unsigned int chunk)
+    {
+        std::shared_ptr<Chunk>& ptr = writableTable().chunks[chunk];
+        if(!owned(ptr))
+        {
+            detached_ += sizeof(Chunk);
+            ptr = newChunk(*ptr);
+        }
+        return ptr.get();
+    }
+
+    // use_count() is a relaxed load. A copy released on another thread
+    // (an edit log snapshot) drops its count with release order; the
+    // fence orders its last reads before the writes that follow here.
+    template <typename U>
+    static bool owned(const std::shared_ptr<U>& ptr)
+    {
+        if(ptr.use_count() > 1)
+        {
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return true;
+    }
+
+    std::size_t tableBytes() const
+    {
+        return sizeof(Table) + table_->chunks.capacity() * sizeof(std::shared_ptr<Chunk>);
+    }
+
+    // What a copy keeps apart once the table is dropped.
+    std::size_t droppedBytes() const
+    {
+        if(!table_)
+        {
+            return 0;
+        }
+        if(table_.use_count() > 1)
+        {
+            return tableBytes() + table_->chunks.size() * sizeof(Chunk);
+        }
+        std::size_t bytes = 0;
+        for(const std::shared_ptr<Chunk>& chunk : table_->chunks)
+        {
+            if(chunk.use_count() > 1)
+            {
+                bytes += sizeof(Chunk);
+            }
+        }
+        return bytes;
+    }
+
+    template <typename... Args>
+    std::shared_ptr<Table> newTable(Args&&... args) const
+    {
+        if(arena_)
+        {
+            return std::allocate_shared<Table>(ArenaAllocator<Table>(arena_), std::forward<Args>(args)...);
+        }
+        return std::make_shared<Table>(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::shared_ptr<Chunk> newChunk(Args&&... args) const
+    {
+        if(arena_)
+        {
+            return std::allocate_shared<Chunk>(ArenaAllocator<Chunk>(arena_), std::forward<Args>(args)...);
+        }
+        return std::make_shared<Chunk>(std::forward<Args>(args)...);
+    }
+
+private:
+    std::shared_ptr<Arena> arena_;
+    std::shared_ptr<Table> table_;
+    std::size_t detached_ = 0;
+};
+
+} // namespace doc
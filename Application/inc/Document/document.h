@@ -1,32 +1,116 @@
 #pragma once
+#include <memory>
+#include <memory_resource>
 #include <unordered_map>
-#include "gets.h"
+#include <utility>
+#include <vector>
+#include "changeJournal.h"
+#include "gateOrder.h"
+#include "netlist.h"
 
 
 namespace doc
 {
 
-class Document
+class Document : public Netlist
 {
+    struct PendingInput
+    {
+        unsigned int sinkId;
+        unsigned int port;
+        unsigned int output;
+    };
+
 public:
-    using iterator = std::unordered_map<unsigned int, Gate>::iterator;
+    // State restore() brings back: the design plus the inputs still
+    // waiting for a driver that was never added. Costs what snapshot()
+    // costs and a copy of those inputs.
+    struct Checkpoint
+    {
+        // Memory the checkpoint keeps alive that `newer`, a later
+        // checkpoint or the document itself, does not.
+        std::size_t bytesApartFrom(const Netlist& newer) const;
+
+        std::shared_ptr<const Netlist> netlist;
+        std::vector<std::pair<unsigned int, PendingInput>> pending;
+    };
 
 public:
+    Document() = default;
+    // Keeps the gates in the given arena, e.g. Arena::mapped() for a
+    // design that does not fit in memory.
+    explicit Document(std::shared_ptr<Arena> arena);
 
-    void addGate(const Gate& gate);
+    // Adds the gate under its own id, or under a fresh slot map id when the
+    // gate has none (Gate::NoGate). Returns the id the gate ended up with.
+    // If one of its inputs would close a loop the gate is not added and
+    // CycleError is thrown; an id that is in use throws invalid_argument.
+    unsigned int addGate(const Gate& gate);
+    // Same without a Gate: `inputs` holds a driver id or Gate::NoGate
+    // per port and `outputs` the output of it the port reads. `fanout`
+    // is what the gate drove when it was removed (undo), a net per
+    // output; sinks that are gone or whose port is driven meanwhile are
+    // skipped.
+    unsigned int addGate(GateType type, const Gate::Inputs& inputs, const Gate::DriverOutputs& outputs = {},
+                         unsigned int id = Gate::NoGate, const std::vector<Net>& fanout = {});
+    // Drops the gate, its edges and its inputs still waiting for a
+    // driver. Whoever may add it back keeps nets(id).
     void removeaGate(unsigned int id);
 
-    iterator begin();
-    iterator end();
-    iterator find(unsigned int id);
-    Gate& at(unsigned int id);
+    // Connects output `output` of the driver to the port. Throws
+    // CycleError, and changes nothing, if the edge would close a loop.
+    void connect(unsigned int driverId, unsigned int port, unsigned int sinkId, unsigned int output = 0);
+    void disconnect(unsigned int port, unsigned int sinkId);
+    void setType(unsigned int id, GateType type);
+
+    // Places a module. Its wires are created here unless instance.outputs
+    // already names them (re-adding a removed instance, with what the
+    // wires drove in `fanout`); the instance gets `id` if given, else a
+    // fresh one. Returns the instance id.
+    unsigned int addInstance(Instance instance, unsigned int id = Gate::NoGate,
+                             const std::vector<Net>& fanout = {});
+    // Drops the instance and its wires.
+    void removeInstance(unsigned int id);
+    void bindInput(unsigned int instanceId, unsigned int port, unsigned int driverId, unsigned int output = 0);
+
+    // Moves the gates within the store into the given order so that
+    // traversals touch nearby memory. Ids do not change, so the undo
+    // history, the scene and snapshots are unaffected.
+    void renumber(GateOrder order);
+
+    // O(1) immutable copy of the current design; later edits to this
+    // document copy only the chunks they touch. The snapshot may be read
+    // on another thread while editing continues here.
+    std::shared_ptr<const Netlist> snapshot() const;
+
+    Checkpoint checkpoint() const;
+    // Puts the document back to `checkpoint`. `touched` must name every
+    // gate added, removed, retyped or rewired in between, either way;
+    // only those and the sinks they drive are compared, and the
+    // difference is published as one batch. Instances are not compared.
+    void restore(const Checkpoint& checkpoint, std::vector<unsigned int> touched);
+
+    // Every edit above is recorded here; one call publishes one batch.
+    ChangeJournal& journal();
+
     unsigned int getGateCaunt();
     void setgateCaunt(unsigned int caunt);
 
 private:
-    std::unordered_map<unsigned int, Gate> gateMap;
+    // Fills a fresh document in bulk.
+    friend class DocumentBuilder;
+
+    void reorder(const std::vector<unsigned int>& order);
+    void addEdge(unsigned int driverIndex, unsigned int port, unsigned int sinkIndex, unsigned int output);
+    void recordEdge(Change::Kind kind, unsigned int driverIndex, unsigned int port, unsigned int sinkIndex,
+                    unsigned int output);
+
+private:
+    // Inputs whose driver has not been added yet, keyed by driver id.
+    std::pmr::unordered_multimap<unsigned int, PendingInput> pending_{ arena_.get() };
+    ChangeJournal journal_;
     unsigned int GateCaunt = 0;
-};  
+};
 
 
 } // namespace doc
@@ -0,0 +1,66 @@
+#pragma once
+#include <memory>
+#include <utility>
+#include <vector>
+#include "document.h"
+
+
+namespace doc
+{
+
+//////////////////////////////////////////////////////////////
+///Document builder
+///Bulk loading for importers. Gates and edges are only collected
+///here; build() then places every gate, writes all fanin, lays out
+///fanout in one counting pass and computes the topological order
+///with one Kahn pass. None of the per-gate bookkeeping of
+///Document::addGate (incremental order, fanout growth, journal) runs.
+///The gates end up stored in topological order, whatever their ids.
+//////////////////////////////////////////////////////////////
+class DocumentBuilder
+{
+public:
+    // Capacity hints, both optional.
+    void reserve(unsigned int gateCaunt, unsigned int edgeCaunt);
+
+    // Takes the given id, or a fresh one for Gate::NoGate, and returns it.
+    // Throws std::invalid_argument if the id is already taken.
+    unsigned int addGate(GateType type, unsigned int id = Gate::NoGate);
+    // Same, and queues the inputs of the gate as edges.
+    unsigned int addGate(const Gate& gate);
+    // Output `output` of the driver feeds the port; the driver may be
+    // added later. A port given twice keeps the last driver.
+    void addEdge(unsigned int driverId, unsigned int port, unsigned int sinkId, unsigned int output = 0);
+    // Places a module over wires added as INPUT gates, which
+    // instance.outputs names, under the given instance id.
+    void addInstance(Instance instance, unsigned int id);
+
+    unsigned int gateCaunt() const;
+
+    // Validates everything collected and hands it over as a document; the
+    // builder is empty afterwards. Inputs naming a gate that was never
+    // added wait for it like Document::addGate inputs do. Throws
+    // std::invalid_argument for an edge into a missing gate and CycleError
+    // for a combinational loop, std::invalid_argument also for an
+    // instance on a missing wire or reading a missing gate. The document
+    // lives in `arena` if given.
+    std::shared_ptr<Document> build(std::shared_ptr<Arena> arena = nullptr);
+
+private:
+    struct Edge
+    {
+        unsigned int driverId;
+        unsigned int port;
+        unsigned int sinkId;
+        unsigned int output;
+    };
+
+    SlotMap slots_;
+    // By slot index.
+    std::vector<GateType> types_;
+    std::vector<Edge> edges_;
+    std::vector<std::pair<unsigned int, Instance>> instances_;
+};
+
+
+} // namespace doc
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "document.h"
+
+namespace doc
+{
+
+//////////////////////////////////////////////////////////////
+///Fingerprint
+///Structural hashes of a document, kept up to date from its change
+///journal.
+///  design  hash of every gate (id, type, driver and driver output of
+///          each port) and every instance (id, module fingerprint,
+///          binding), summed, so it does not depend on store order or
+///          edit history and each change updates it in O(1). Equal
+///          documents hash equal, after a save and reload too.
+///  cone    Merkle hash of the fanin cone of a gate: its type and the
+///          cones (and which of their outputs) feeding its ports, down
+///          to INPUT gates, which hash by id. Other ids do not enter,
+///          so two copies of a circuit over the same inputs hash equal.
+///          An edit only marks the fanout cone stale; cones are
+///          rehashed when asked for.
+///Both see the document as of its last published batch.
+//////////////////////////////////////////////////////////////
+class Fingerprint
+{
+public:
+    explicit Fingerprint(Document& doc);
+    ~Fingerprint();
+    Fingerprint(const Fingerprint&) = delete;
+    Fingerprint& operator=(const Fingerprint&) = delete;
+
+    std::uint64_t design() const;
+    // 0 for a gate the document does not have.
+    std::uint64_t cone(unsigned int id) const;
+    void rebuild();
+
+private:
+    void apply(const ChangeBatch& batch);
+    void updateGate(unsigned int id);
+    void updateInstance(unsigned int id);
+    void markStale(unsigned int id);
+    std::uint64_t rehash(unsigned int index) const;
+
+private:
+    Document& doc_;
+    unsigned int subscription_;
+    std::uint64_t design_ = 0;
+    // By slot index; what each gate and instance adds to design_.
+    std::vector<std::uint64_t> gates_;
+    std::vector<std::uint64_t> instances_;
+    // By slot index. A stale gate has a stale fanout cone.
+    mutable std::vector<std::uint64_t> cones_;
+    mutable std::vector<unsigned char> stale_;
+    mutable std::vector<unsigned int> stack_;
+};
+
+// Design hash of a netlist in one full walk, the value a Fingerprint
+// following the same design would have.
+std::uint64_t designFingerprint(const Netlist& netlist);
+
+} // namespace doc
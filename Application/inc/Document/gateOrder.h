@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+#include "netlistStore.h"
+
+namespace doc
+{
+
+//////////////////////////////////////////////////////////////
+///Gate orders
+///Orders the live gates of a store for Document::renumber(), which
+///places them at consecutive store indices so that the fanin of a gate
+///is usually stored next to it.
+///  DepthFirst   post-order over fanin starting from the gates that
+///               drive nothing: each fanin cone is laid out in one run
+///               right before the gate it feeds. Drivers come first.
+///  Topological  the order the document already maintains.
+///  CuthillMcKee reverse Cuthill-McKee over fanin and fanout: breadth
+///               first from a low-degree gate, which keeps the spread
+///               between connected gates small in both directions.
+//////////////////////////////////////////////////////////////
+enum class GateOrder
+{
+    DepthFirst,
+    Topological,
+    CuthillMcKee
+};
+
+// Store indices of the live gates.
+std::vector<unsigned int> depthFirstOrder(const NetlistStore& store);
+std::vector<unsigned int> cuthillMcKeeOrder(const NetlistStore& store);
+
+} // namespace doc
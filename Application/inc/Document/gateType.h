@@ -0,0 +1,156 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace doc
+{
+
+enum class GateType : unsigned char
+{
+    INPUT,
+    OUTPUT,
+    AND_2,
+    AND_3,
+    AND_4,
+    MUX_2,
+    MUX_4,
+    HALF_ADDER,
+    FULL_ADDER,
+    OR_2,
+    OR_3,
+    OR_4,
+    NAND_2,
+    NAND_3,
+    NAND_4,
+    NOR_2,
+    NOR_3,
+    NOR_4,
+    NOT,
+    XOR_2,
+    XOR_3,
+    XOR_4,
+    XNOR_2,
+    XNOR_3,
+    XNOR_4
+};
+
+constexpr unsigned int GateTypeCaunt = static_cast<unsigned int>(GateType::XNOR_4) + 1;
+constexpr unsigned int MaxGateInputs = 6;
+constexpr unsigned int MaxGateOutputs = 2;
+
+//////////////////////////////////////////////////////////////
+///Gate descriptor
+///Everything the engines need to know about a gate kind. The truth
+///table of output k holds the output value for input row r at bit r,
+///where bit i of r is the value of input pin i (6 pins -> 64 rows).
+//////////////////////////////////////////////////////////////
+struct GateDescriptor
+{
+    GateType type;
+    const char* name;
+    unsigned char inputCaunt;
+    unsigned char outputCaunt;
+    std::array<const char*, MaxGateInputs> inputNames;
+    std::array<const char*, MaxGateOutputs> outputNames;
+    std::array<std::uint64_t, MaxGateOutputs> truthTable;
+    const char* symbol;
+};
+
+namespace detail
+{
+
+enum class Fn { None, Buf, And, Or, Xor, Mux, HalfSum, HalfCarry, FullSum, FullCarry };
+
+constexpr bool evalRow(Fn fn, unsigned int n, unsigned int row)
+{
+    unsigned int ones = 0;
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        ones += (row >> i) & 1u;
+    }
+    switch(fn)
+    {
+    case Fn::Buf:       return row & 1u;
+    case Fn::And:       return ones == n;
+    case Fn::Or:        return ones != 0;
+    case Fn::Xor:       return ones & 1u;
+    case Fn::HalfSum:   return ones & 1u;
+    case Fn::HalfCarry: return ones == 2;
+    case Fn::FullSum:   return ones & 1u;
+    case Fn::FullCarry: return ones >= 2;
+    case Fn::Mux:
+    {
+        // data pins first, select pins after them
+        unsigned int selectBits = n == 3 ? 1 : 2;
+        unsigned int data = n - selectBits;
+        unsigned int select = (row >> data) & ((1u << selectBits) - 1);
+        return (row >> select) & 1u;
+    }
+    default:            return false;
+    }
+}
+
+constexpr std::uint64_t table(Fn fn, unsigned int n, bool invert = false)
+{
+    if(fn == Fn::None)
+    {
+        return 0;
+    }
+    std::uint64_t bits = 0;
+    for(unsigned int row = 0; row < (1u << n); ++row)
+    {
+        if(evalRow(fn, n, row) != invert)
+        {
+            bits |= std::uint64_t(1) << row;
+        }
+    }
+    return bits;
+}
+
+} // namespace detail
+
+constexpr std::array<GateDescriptor, GateTypeCaunt> gateDescriptors = {{
+    { GateType::INPUT,      "INPUT",      0, 1, {},                                 { "Y" },          { 0 },                                                                            ":/Resources/LogicGates/input.png" },
+    { GateType::OUTPUT,     "OUTPUT",     1, 0, { "A" },                            {},               { 0 },                                                                            ":/Resources/LogicGates/output.png" },
+    { GateType::AND_2,      "AND_2",      2, 1, { "A", "B" },                       { "Y" },          { detail::table(detail::Fn::And, 2) },                                            ":/Resources/LogicGates/and.png" },
+    { GateType::AND_3,      "AND_3",      3, 1, { "A", "B", "C" },                  { "Y" },          { detail::table(detail::Fn::And, 3) },                                            ":/Resources/LogicGates/and_3.png" },
+    { GateType::AND_4,      "AND_4",      4, 1, { "A", "B", "C", "D" },             { "Y" },          { detail::table(detail::Fn::And, 4) },                                            ":/Resources/LogicGates/and_4.png" },
+    { GateType::MUX_2,      "MUX_2",      3, 1, { "D0", "D1", "S" },                { "Y" },          { detail::table(detail::Fn::Mux, 3) },                                            ":/Resources/LogicGates/mux_2.png" },
+    { GateType::MUX_4,      "MUX_4",      6, 1, { "D0", "D1", "D2", "D3", "S0", "S1" }, { "Y" },      { detail::table(detail::Fn::Mux, 6) },                                            ":/Resources/LogicGates/mux_4.png" },
+    { GateType::HALF_ADDER, "HALF_ADDER", 2, 2, { "A", "B" },                       { "S", "C" },     { detail::table(detail::Fn::HalfSum, 2), detail::table(detail::Fn::HalfCarry, 2) }, ":/Resources/LogicGates/half_adder.png" },
+    { GateType::FULL_ADDER, "FULL_ADDER", 3, 2, { "A", "B", "CIN" },                { "S", "COUT" },  { detail::table(detail::Fn::FullSum, 3), detail::table(detail::Fn::FullCarry, 3) }, ":/Resources/LogicGates/full_adder.png" },
+    { GateType::OR_2,       "OR_2",       2, 1, { "A", "B" },                       { "Y" },          { detail::table(detail::Fn::Or, 2) },                                             ":/Resources/LogicGates/or.png" },
+    { GateType::OR_3,       "OR_3",       3, 1, { "A", "B", "C" },                  { "Y" },          { detail::table(detail::Fn::Or, 3) },                                             ":/Resources/LogicGates/or_3.png" },
+    { GateType::OR_4,       "OR_4",       4, 1, { "A", "B", "C", "D" },             { "Y" },          { detail::table(detail::Fn::Or, 4) },                                             ":/Resources/LogicGates/or_4.png" },
+    { GateType::NAND_2,     "NAND_2",     2, 1, { "A", "B" },                       { "Y" },          { detail::table(detail::Fn::And, 2, true) },                                      ":/Resources/LogicGates/nand.png" },
+    { GateType::NAND_3,     "NAND_3",     3, 1, { "A", "B", "C" },                  { "Y" },          { detail::table(detail::Fn::And, 3, true) },                                      ":/Resources/LogicGates/nand_3.png" },
+    { GateType::NAND_4,     "NAND_4",     4, 1, { "A", "B", "C", "D" },             { "Y" },          { detail::table(detail::Fn::And, 4, true) },                                      ":/Resources/LogicGates/nand_4.png" },
+    { GateType::NOR_2,      "NOR_2",      2, 1, { "A", "B" },                       { "Y" },          { detail::table(detail::Fn::Or, 2, true) },                                       ":/Resources/LogicGates/nor.png" },
+    { GateType::NOR_3,      "NOR_3",      3, 1, { "A", "B", "C" },                  { "Y" },          { detail::table(detail::Fn::Or, 3, true) },                                       ":/Resources/LogicGates/nor_3.png" },
+    { GateType::NOR_4,      "NOR_4",      4, 1, { "A", "B", "C", "D" },             { "Y" },          { detail::table(detail::Fn::Or, 4, true) },                                       ":/Resources/LogicGates/nor_4.png" },
+    { GateType::NOT,        "NOT",        1, 1, { "A" },                            { "Y" },          { detail::table(detail::Fn::Buf, 1, true) },                                      ":/Resources/LogicGates/not.png" },
+    { GateType::XOR_2,      "XOR_2",      2, 1, { "A", "B" },                       { "Y" },          { detail::table(detail::Fn::Xor, 2) },                                            ":/Resources/LogicGates/xor.png" },
+    { GateType::XOR_3,      "XOR_3",      3, 1, { "A", "B", "C" },                  { "Y" },          { detail::table(detail::Fn::Xor, 3) },                                            ":/Resources/LogicGates/xor_3.png" },
+    { GateType::XOR_4,      "XOR_4",      4, 1, { "A", "B", "C", "D" },             { "Y" },          { detail::table(detail::Fn::Xor, 4) },                                            ":/Resources/LogicGates/xor_4.png" },
+    { GateType::XNOR_2,     "XNOR_2",     2, 1, { "A", "B" },                       { "Y" },          { detail::table(detail::Fn::Xor, 2, true) },                                      ":/Resources/LogicGates/xnor.png" },
+    { GateType::XNOR_3,     "XNOR_3",     3, 1, { "A", "B", "C" },                  { "Y" },          { detail::table(detail::Fn::Xor, 3, true) },                                      ":/Resources/LogicGates/xnor_3.png" },
+    { GateType::XNOR_4,     "XNOR_4",     4, 1, { "A", "B", "C", "D" },             { "Y" },          { detail::table(detail::Fn::Xor, 4, true) },                                      ":/Resources/LogicGates/xnor_4.png" },
+}};
+
+constexpr const GateDescriptor& descriptor(GateType type)
+{
+    return gateDescriptors[static_cast<unsigned int>(type)];
+}
+
+constexpr bool evaluate(GateType type, unsigned int output, unsigned int inputBits)
+{
+    return (descriptor(type).truthTable[output] >> inputBits) & 1u;
+}
+
+const char* gateTypeName(GateType type);
+// Returns nullptr for names that are not a known gate kind.
+const GateDescriptor* findGateDescriptor(const std::string& name);
+GateType gateTypeFromName(const std::string& name);
+
+} // namespace doc
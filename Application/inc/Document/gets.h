@@ -1,42 +1,62 @@
 #pragma once
 
-#include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <array>
+#include "gateType.h"
+#include "smallVector.h"
 
 namespace doc
 {
 
+// Memory per gate (x86-64, libstdc++), for a 4-input gate driving 3 sinks:
+//   before: unordered_map + unordered_set headers (2 x 56 B), string (32 B),
+//           id, plus 7 heap nodes (~32 B each) and 2 bucket arrays
+//           (~104 B each) -> about 580 B and 10 allocations.
+//   now:    inline fanin array (24 B) and the driver output per port
+//           (6 B), fanout small vector with 4 inline slots (24 B), one
+//           byte GateType, id -> 64 B and no allocations until a gate
+//           drives more than 4 sinks.
 class Gate
 {
 public:
-    Gate() = default;  // Default constructor
-    void setInputs(std::unordered_map<unsigned int, unsigned int>&& inputs);
-    void setConects(std::unordered_set<unsigned int>&& conects);
+    // Largest primitive (MUX_4: 4 data + 2 select) has six input pins.
+    static constexpr unsigned int MaxInputs = MaxGateInputs;
+    static constexpr unsigned int NoGate = ~0u;
+    using Inputs = std::array<unsigned int, MaxInputs>;
+    // Which output of its driver each port reads.
+    using DriverOutputs = std::array<unsigned char, MaxInputs>;
+    using Conects = SmallVector<unsigned int, 4>;
+
+public:
+    Gate();
+    void setInputs(const Inputs& inputs);
+    void setDriverOutputs(const DriverOutputs& outputs);
+    void setConects(Conects&& conects);
     void setId(unsigned int id);
-    void setType(const std::string& type);
+    void setType(GateType type);
 
-    void addInput(unsigned int inputPort, unsigned int id);
+    void addInput(unsigned int inputPort, unsigned int id, unsigned int output = 0);
     void removeInput(unsigned int inputPort);
 
     void addConect(unsigned int gateId);
     void removeConect(unsigned int gateId);
 
-    std::unordered_set<unsigned int>& getConects() ;
-    std::unordered_map<unsigned int, unsigned int>& getInputs();
-    const std::string& getType() const ;
+    const Conects& getConects() const;
+    const Inputs& getInputs() const;
+    const DriverOutputs& getDriverOutputs() const;
+    GateType getType() const ;
     unsigned int getInput(unsigned int inputPort) const;
+    unsigned int getDriverOutput(unsigned int inputPort) const;
+    unsigned int getInputCaunt() const;
     unsigned int getId() const ;
 
 
 
 private:
-    std::unordered_map<unsigned int, unsigned int> inputs;
-    std::unordered_set<unsigned int> conects;
-    std::string type;
-    unsigned int id;
-//    unsigned int input1;
-//    unsigned int input2;
+    Inputs inputs;
+    DriverOutputs driverOutputs{};
+    Conects conects;
+    GateType type = GateType::INPUT;
+    unsigned int id = NoGate;
 
 };
 
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "netlist.h"
+
+
+namespace doc
+{
+
+class Document;
+
+//////////////////////////////////////////////////////////////
+///Module
+///Definition of a reusable design. The body is an immutable netlist
+///shared by every instance (flyweight), so an instance costs its port
+///binding and one wire gate per output, whatever the body size.
+///Module inputs are the INPUT gates of the body that are not wires of
+///nested instances, outputs are its OUTPUT gates, both by slot index
+///of their ids, which renumbering the body does not change.
+//////////////////////////////////////////////////////////////
+class Module
+{
+public:
+    // `path` is the file the body was loaded from, if any.
+    Module(std::string name, std::shared_ptr<const Netlist> body, std::string path = {});
+
+    const std::string& name() const;
+    // Empty for a module built in memory (extractModules), which a save
+    // has to hold in full.
+    const std::string& path() const;
+    const Netlist& body() const;
+
+    unsigned int inputCaunt() const;
+    unsigned int outputCaunt() const;
+    // Body gate id of a port.
+    unsigned int input(unsigned int port) const;
+    unsigned int output(unsigned int port) const;
+
+    // Gates the body expands to, nested instances included, ports not.
+    unsigned long long flatGateCaunt() const;
+    // Design fingerprint of the body; equal bodies share it.
+    std::uint64_t fingerprint() const;
+
+private:
+    std::string name_;
+    std::shared_ptr<const Netlist> body_;
+    std::string path_;
+    std::vector<unsigned int> inputs_;
+    std::vector<unsigned int> outputs_;
+    unsigned long long flatGateCaunt_ = 0;
+    std::uint64_t fingerprint_ = 0;
+};
+
+// Expands every instance, recursively, into plain gates. Gates of the
+// netlist itself keep their ids, expanded gates get fresh ones; module
+// ports and wires are bypassed. Throws CycleError if the expansion
+// closes a combinational loop through an instance. The result lives in
+// `arena` if given; flattened designs can outgrow memory.
+std::shared_ptr<Document> flatten(const Netlist& netlist, std::shared_ptr<Arena> arena = nullptr);
+
+// A cone findModules() folds, by gate ids.
+struct FoldedCone
+{
+    unsigned int root;
+    std::vector<unsigned int> gates;    // root first
+    std::vector<unsigned int> leaves;   // gates outside it that it reads, one per module input
+    std::vector<unsigned int> leafOutputs;  // output of each leaf read
+    std::shared_ptr<const Module> module;
+};
+
+// The inverse: finds fanout-free cones (a gate and the gates that feed
+// only it, none read by an instance, all with one output) that are
+// isomorphic by canonical shape, and makes each shape seen at least
+// `minCaunt` times with at least `minGates` gates one shared module.
+// The netlist is left as it is; edt::extractModules() folds the cones.
+// They come in topological order, so a leaf may be the root of an
+// earlier cone, never of a later one.
+std::vector<FoldedCone> findModules(const Netlist& netlist, unsigned int minGates = 3, unsigned int minCaunt = 2);
+
+
+} // namespace doc
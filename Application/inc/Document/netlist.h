@@ -0,0 +1,139 @@
+#pragma once
+#include <iterator>
+#include <memory>
+#include <vector>
+#include "cowVector.h"
+#include "gets.h"
+#include "netlistStore.h"
+#include "slotMap.h"
+#include "topoOrder.h"
+
+
+namespace doc
+{
+
+class Module;
+
+// A placed copy of a module: the shared definition plus the port binding.
+// Each module output drives a wire, an INPUT gate of this netlist that
+// the surrounding gates read from.
+struct Instance
+{
+    std::shared_ptr<const Module> module;
+    std::vector<unsigned int> inputs;    // gate driving each module input, Gate::NoGate if open
+    std::vector<unsigned int> outputs;   // wire gate of each module output
+    // Output of the driver each input reads; missing entries read output 0.
+    std::vector<unsigned char> driverOutputs;
+};
+
+// One gate input.
+struct Pin
+{
+    unsigned int gateId;
+    unsigned int port;
+};
+
+// What one gate output drives: every gate input connected to it.
+struct Net
+{
+    unsigned int driver;
+    std::vector<Pin> sinks;
+    unsigned int output = 0;
+};
+
+//////////////////////////////////////////////////////////////
+///Netlist
+///Read-only view of a design: the gate store plus the slot map and
+///position table that turn gate ids into store indices. Document adds editing on top of
+///it, and a Netlist copy is an immutable snapshot of a Document.
+///Module instances are kept unexpanded next to the gates; flatten()
+///turns a netlist with instances into plain gates.
+//////////////////////////////////////////////////////////////
+class Netlist
+{
+public:
+    // Walks the live gates of the store and materializes them as Gate values.
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Gate;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Gate;
+
+        iterator(const Netlist* netlist, unsigned int index);
+        Gate operator*() const;
+        iterator& operator++();
+        bool operator==(const iterator& other) const;
+        bool operator!=(const iterator& other) const;
+        unsigned int index() const;
+
+    private:
+        void skipDead();
+
+    private:
+        const Netlist* netlist_;
+        unsigned int index_;
+    };
+
+public:
+    // Gate data of this netlist is allocated from the arena, a fresh
+    // heap arena if none is given.
+    Netlist();
+    explicit Netlist(std::shared_ptr<Arena> arena);
+
+    iterator begin() const;
+    iterator end() const;
+    iterator find(unsigned int id) const;
+    Gate at(unsigned int id) const;
+    GateType typeOf(unsigned int id) const;
+    // Id of the gate feeding this port, Gate::NoGate if it is open.
+    unsigned int driverOf(unsigned int port, unsigned int sinkId) const;
+    // Output of that gate the port reads, 0 if it is open.
+    unsigned int driverOutputOf(unsigned int port, unsigned int sinkId) const;
+    // Driver id per port, Gate::NoGate for open ones; builds no Gate.
+    Gate::Inputs inputsOf(unsigned int id) const;
+    Gate::DriverOutputs driverOutputsOf(unsigned int id) const;
+    Net net(unsigned int driverId, unsigned int output = 0) const;
+    // One net per output of the gate that drives anything.
+    std::vector<Net> nets(unsigned int driverId) const;
+    bool contains(unsigned int id) const;
+    unsigned int size() const;
+    unsigned int indexOf(unsigned int id) const;
+    const NetlistStore& store() const;
+    const TopoOrder& topoOrder() const;
+    // Ids of all gates, every driver before the gates it feeds.
+    std::vector<unsigned int> topologicalOrder() const;
+    // Memory this netlist holds that `other` does not share, e.g. what a
+    // snapshot keeps alive once the document has moved on.
+    std::size_t bytesApartFrom(const Netlist& other) const;
+    // Memory let go of while a snapshot shared it, ever growing: a
+    // snapshot keeps at most the growth since it was taken apart from
+    // this netlist, found without walking the chunks.
+    std::size_t detachedBytes() const;
+
+    const Instance& instance(unsigned int id) const;
+    bool containsInstance(unsigned int id) const;
+    unsigned int instanceCaunt() const;
+    std::vector<unsigned int> instanceIds() const;
+
+protected:
+    Gate makeGate(unsigned int index) const;
+    void setPosition(unsigned int id, unsigned int index);
+
+protected:
+    // Shared with snapshots, which keep it alive.
+    std::shared_ptr<Arena> arena_;
+    NetlistStore store_;
+    SlotMap slots_;
+    // Store index of the gate in each slot. Gates move within the store
+    // (renumbering, compaction) while their ids stay the same.
+    CowVector<unsigned int> position_;
+    TopoOrder topo_;
+    CowVector<Instance, 6> instances_;
+    SlotMap instanceSlots_;
+};
+
+
+} // namespace doc
@@ -0,0 +1,121 @@
+#pragma once
+#include <vector>
+#include "cowVector.h"
+#include "gateType.h"
+
+namespace doc
+{
+
+//////////////////////////////////////////////////////////////
+///Netlist store
+///Structure-of-arrays storage of all gates of a document.
+///Every gate lives at a dense index (the netlist maps ids to it);
+///removed gates stay as dead entries until the store is reordered
+///or packed. Fanin slots of a gate are a contiguous block in one
+///flat array, and a parallel byte array names the output of the driver
+///each slot reads. Fanout is a block per gate in a
+///second flat array, kept in step with fanin on every edit: a full
+///block moves to the end of the array with twice the room. A fanout
+///entry is a sink pin and the driver output feeding it, packed in one
+///word, so the block of a gate is the sink lists of the nets its
+///outputs drive.
+///All arrays are copy-on-write, so copying a store is O(1) and the
+///copy stays unchanged while the original is edited.
+//////////////////////////////////////////////////////////////
+class NetlistStore
+{
+public:
+    static constexpr unsigned int npos = ~0u;
+
+public:
+    unsigned int addGate(unsigned int id, GateType type, unsigned int pinCaunt);
+    // Puts a gate into a given slot, growing the store with dead entries if needed.
+    void placeGate(unsigned int index, unsigned int id, GateType type, unsigned int pinCaunt);
+    void removeGate(unsigned int index);
+    void clear();
+
+    void setFanin(unsigned int index, unsigned int port, unsigned int driver, unsigned int output = 0);
+    void clearFanin(unsigned int index, unsigned int port);
+    void setType(unsigned int index, GateType type);
+
+    unsigned int size() const;
+    unsigned int liveCaunt() const;
+    bool isAlive(unsigned int index) const;
+    unsigned int id(unsigned int index) const;
+    GateType type(unsigned int index) const;
+
+    unsigned int faninCaunt(unsigned int index) const;
+    unsigned int fanin(unsigned int index, unsigned int port) const;
+    // Output of the driver the port reads, 0 for an open port.
+    unsigned int faninOutput(unsigned int index, unsigned int port) const;
+    const unsigned int* faninBegin(unsigned int index) const;
+    const unsigned int* faninEnd(unsigned int index) const;
+
+    // One entry per connected pin, so a sink fed on two ports is listed
+    // twice; entries are in no particular order.
+    unsigned int fanoutCaunt(unsigned int index) const;
+    // Sink gate and its input port of entry k, and the output feeding it.
+    unsigned int fanoutAt(unsigned int index, unsigned int k) const;
+    unsigned int fanoutPort(unsigned int index, unsigned int k) const;
+    unsigned int fanoutOutput(unsigned int index, unsigned int k) const;
+
+    // Bulk load: writes fanin without touching fanout, which one
+    // rebuildFanout() call then lays out for every gate at once.
+    void initFanin(unsigned int index, unsigned int port, unsigned int driver, unsigned int output = 0);
+    void rebuildFanout();
+
+    // Rebuilds the store with the gates of `order` (old indices) at
+    // indices 0, 1, ...; gates left out are dropped and so are their
+    // edges. Returns old index -> new index, npos for dropped gates.
+    std::vector<unsigned int> reorder(const std::vector<unsigned int>& order);
+    // Drops dead gates and fanin holes; returns old index -> new index.
+    std::vector<unsigned int> compact();
+    void reserve(unsigned int gateCaunt, unsigned int faninCaunt);
+    // Arrays grown or rewritten from now on take their chunks from the arena.
+    void setArena(const std::shared_ptr<Arena>& arena);
+    // Chunk memory not shared with `other`, e.g. an older copy.
+    std::size_t bytesApartFrom(const NetlistStore& other) const;
+    // Chunk memory let go of while shared; see CowVector::detachedBytes().
+    std::size_t detachedBytes() const;
+
+private:
+    using FaninArray = CowVector<unsigned int>;
+    using OutputArray = CowVector<unsigned char>;
+
+    static constexpr unsigned int PortBits = 3;
+    static constexpr unsigned int OutputBits = 1;
+    static_assert(MaxGateInputs <= (1u << PortBits), "a port must fit in PortBits");
+    static_assert(MaxGateOutputs <= (1u << OutputBits), "an output must fit in OutputBits");
+
+    static unsigned int makePin(unsigned int sink, unsigned int port, unsigned int output)
+    {
+        return (sink << (PortBits + OutputBits)) | (output << PortBits) | port;
+    }
+
+    // Blocks take the same offsets in fanin and its outputs.
+    static unsigned int allocFanin(FaninArray& fanin, OutputArray& outputs, unsigned int pinCaunt, unsigned int& holes);
+    void growFanin(unsigned int index, unsigned int pinCaunt);
+    void compactFanin();
+    void addSink(unsigned int driver, unsigned int sink, unsigned int port, unsigned int output);
+    void removeSink(unsigned int driver, unsigned int sink, unsigned int port, unsigned int output);
+    void compactFanout();
+
+private:
+    CowVector<GateType> types_;
+    CowVector<unsigned int> ids_;
+    CowVector<unsigned char> alive_;
+    CowVector<unsigned int> faninOffset_;
+    CowVector<unsigned int> faninSize_;
+    // Fanin blocks never straddle a chunk, so a block is one contiguous run.
+    FaninArray fanin_;
+    OutputArray faninOutput_;
+    CowVector<unsigned int> fanoutOffset_;
+    CowVector<unsigned int> fanoutSize_;
+    CowVector<unsigned int> fanoutRoom_;
+    CowVector<unsigned int> fanout_;
+    unsigned int liveCaunt_ = 0;
+    unsigned int faninHoles_ = 0;
+    unsigned int fanoutHoles_ = 0;
+};
+
+} // namespace doc
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "document.h"
+
+namespace doc
+{
+
+//////////////////////////////////////////////////////////////
+///Reachability index
+///Answers "does gate A reach gate B" for a document, kept up to date
+///from its change journal. Every gate hashes to one of 64 bits; `down`
+///of a gate holds the bits of everything it reaches, `up` the bits of
+///everything reaching it. A reaches B only if A comes first in the
+///topological order, down(A) covers down(B) and up(B) covers up(A),
+///so most negative queries end in O(1). rebuild() also numbers a
+///spanning forest of the fanout edges; B inside the interval of A is a
+///positive answer in O(1). Undecided queries run a forward search
+///that only enters gates passing the same checks against B.
+///Adding an edge ORs the labels along the cone until nothing changes
+///(each label can change at most 64 times). Removing one changes
+///nothing: labels only get too wide, which keeps the checks sound
+///but weaker, so they are rebuilt after many removals. Removing a
+///forest edge turns the intervals off until the next rebuild.
+///Queries see the document as of its last published batch.
+//////////////////////////////////////////////////////////////
+class ReachIndex
+{
+public:
+    explicit ReachIndex(Document& doc);
+    ~ReachIndex();
+    ReachIndex(const ReachIndex&) = delete;
+    ReachIndex& operator=(const ReachIndex&) = delete;
+
+    // True if `to` is `from` or lies in its fanout cone.
+    bool reaches(unsigned int fromId, unsigned int toId) const;
+    void rebuild();
+
+private:
+    using Label = std::uint64_t;
+
+    struct Interval
+    {
+        unsigned int id = Gate::NoGate;
+        unsigned int parentSlot = ~0u;
+        unsigned int first = 0;
+        unsigned int last = 0;
+    };
+
+    static Label bitOf(unsigned int slot);
+    unsigned int slotOf(unsigned int index) const;
+    void apply(const ChangeBatch& batch);
+    void resetGate(unsigned int slot);
+    void numberForest(const std::vector<unsigned int>& order);
+    void spreadDown(unsigned int driver, unsigned int sink);
+    void spreadUp(unsigned int driver, unsigned int sink);
+
+private:
+    Document& doc_;
+    unsigned int subscription_;
+    // By slot index of the gate id, which renumbering does not change.
+    std::vector<Label> down_;
+    std::vector<Label> up_;
+    std::vector<Interval> forest_;
+    bool forestValid_ = false;
+    unsigned int removedEdges_ = 0;
+    // Search scratch, by store index.
+    mutable std::vector<unsigned char> seen_;
+    mutable std::vector<unsigned int> stack_;
+};
+
+} // namespace doc
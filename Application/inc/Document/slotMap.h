@@ -0,0 +1,54 @@
+#pragma once
+#include "cowVector.h"
+
+namespace doc
+{
+
+//////////////////////////////////////////////////////////////
+///Slot map
+///Hands out gate ids that are a dense slot index (low 24 bits) plus
+///a generation counter (high 8 bits). Released slots are reused
+///through a free list and their generation is bumped, so an id that
+///outlived its gate is detected as stale instead of aliasing the new
+///occupant (until the same slot has been recycled 256 times).
+//////////////////////////////////////////////////////////////
+class SlotMap
+{
+public:
+    static constexpr unsigned int IndexBits = 24;
+    static constexpr unsigned int IndexMask = (1u << IndexBits) - 1;
+    static constexpr unsigned int MaxSlots = IndexMask;   // IndexMask itself is reserved for InvalidId
+    static constexpr unsigned int InvalidId = ~0u;
+
+    static unsigned int indexOf(unsigned int id) { return id & IndexMask; }
+    static unsigned int generationOf(unsigned int id) { return id >> IndexBits; }
+    static unsigned int makeId(unsigned int index, unsigned int generation) { return (generation << IndexBits) | index; }
+
+public:
+    unsigned int allocate();
+    // Claims exactly this id, e.g. when loading a file or undoing a removal.
+    // Returns false if the slot is already in use.
+    bool allocateAt(unsigned int id);
+    void release(unsigned int id);
+    bool isValid(unsigned int id) const;
+    unsigned int idAt(unsigned int index) const;
+
+    unsigned int capacity() const;
+    unsigned int size() const;
+    void clear();
+    void setArena(const std::shared_ptr<Arena>& arena);
+    std::size_t bytesApartFrom(const SlotMap& other) const;
+    std::size_t detachedBytes() const;
+
+private:
+    void growTo(unsigned int slots);
+
+private:
+    CowVector<unsigned char> generation_;
+    CowVector<unsigned char> used_;
+    // May hold slots that were claimed by allocateAt(); allocate() skips them.
+    CowVector<unsigned int> freeList_;
+    unsigned int size_ = 0;
+};
+
+} // namespace doc
@@ -0,0 +1,164 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+namespace doc
+{
+
+//////////////////////////////////////////////////////////////
+///Small vector
+///Keeps up to N elements inline and spills to the heap only when
+///it grows past that. Meant for short lists of plain ids such as
+///gate fanout, so only trivially copyable types are allowed.
+//////////////////////////////////////////////////////////////
+template <typename T, unsigned int N>
+class SmallVector
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVector holds trivially copyable values only");
+
+public:
+    SmallVector() = default;
+
+    SmallVector(const SmallVector& other)
+    {
+        assign(other);
+    }
+
+    SmallVector(SmallVector&& other) noexcept
+    {
+        steal(other);
+    }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if(this != &other)
+        {
+            release();
+            assign(other);
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept
+    {
+        if(this != &other)
+        {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+
+    ~SmallVector()
+    {
+        release();
+    }
+
+    void push_back(const T& value)
+    {
+        if(size_ == capacity_)
+        {
+            grow(capacity_ * 2);
+        }
+        data()[size_++] = value;
+    }
+
+    // Removes the first element equal to value; order is not preserved.
+    bool eraseValue(const T& value)
+    {
+        T* it = std::find(begin(), end(), value);
+        if(it == end())
+        {
+            return false;
+        }
+        *it = data()[--size_];
+        return true;
+    }
+
+    bool contains(const T& value) const
+    {
+        return std::find(begin(), end(), value) != end();
+    }
+
+    void clear()
+    {
+        size_ = 0;
+    }
+
+    unsigned int size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool isInline() const { return capacity_ == N; }
+
+    T* data() { return isInline() ? inline_ : heap_; }
+    const T* data() const { return isInline() ? inline_ : heap_; }
+    T* begin() { return data(); }
+    T* end() { return data() + size_; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size_; }
+    T& operator[](unsigned int i) { return data()[i]; }
+    const T& operator[](unsigned int i) const { return data()[i]; }
+
+    // Heap bytes owned by this container (0 while inline).
+    std::size_t heapBytes() const
+    {
+        return isInline() ? 0 : capacity_ * sizeof(T);
+    }
+
+private:
+    void grow(unsigned int capacity)
+    {
+        T* heap = new T[capacity];
+        std::memcpy(heap, data(), size_ * sizeof(T));
+        release();
+        heap_ = heap;
+        capacity_ = capacity;
+    }
+
+    void assign(const SmallVector& other)
+    {
+        if(other.size_ > N)
+        {
+            heap_ = new T[other.size_];
+            capacity_ = other.size_;
+        }
+        std::memcpy(data(), other.data(), other.size_ * sizeof(T));
+        size_ = other.size_;
+    }
+
+    void steal(SmallVector& other)
+    {
+        if(other.isInline())
+        {
+            std::memcpy(inline_, other.inline_, other.size_ * sizeof(T));
+        }
+        else
+        {
+            heap_ = other.heap_;
+            capacity_ = other.capacity_;
+            other.capacity_ = N;
+        }
+        size_ = other.size_;
+        other.size_ = 0;
+    }
+
+    void release()
+    {
+        if(!isInline())
+        {
+            delete[] heap_;
+            capacity_ = N;
+        }
+    }
+
+private:
+    unsigned int size_ = 0;
+    unsigned int capacity_ = N;
+    union
+    {
+        T inline_[N];
+        T* heap_;
+    };
+};
+
+} // namespace doc
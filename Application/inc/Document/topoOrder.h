@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "cowVector.h"
+#include "netlistStore.h"
+
+namespace doc
+{
+
+// Thrown when an edge would close a combinational loop; the netlist is
+// left unchanged.
+class CycleError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+//////////////////////////////////////////////////////////////
+///Topological order
+///Keeps the gates of a store in a linked list where every driver sits
+///before its sinks. Each gate carries a 64-bit label that grows along
+///the list, so comparing two gates is O(1); labels leave gaps and a
+///crowded range is relabeled locally (order-maintenance list).
+///An edge that agrees with the order costs O(1). Otherwise, as in
+///Pearce-Kelly, only gates between the two ends are searched: forward
+///from the sink and backward from the driver in turns, and the side
+///that finishes first is moved past the other end. Cost follows the
+///smaller affected cone, not the design size. Removing an edge never
+///breaks the order.
+//////////////////////////////////////////////////////////////
+class TopoOrder
+{
+public:
+    static constexpr unsigned int npos = ~0u;
+
+public:
+    // A new gate has no edges yet and goes at the end.
+    void addNode(unsigned int index);
+    void removeNode(unsigned int index);
+    // Call before driver -> sink is added to the store. Throws CycleError
+    // if sink already reaches driver.
+    void insertEdge(const NetlistStore& store, unsigned int driver, unsigned int sink);
+    void clear();
+    // Replaces the order with the given one, e.g. after a bulk load.
+    void assign(const std::vector<unsigned int>& order);
+    void setArena(const std::shared_ptr<Arena>& arena);
+    std::size_t bytesApartFrom(const TopoOrder& other) const;
+    std::size_t detachedBytes() const;
+
+    bool contains(unsigned int index) const;
+    bool precedes(unsigned int a, unsigned int b) const;
+    // Store indices of the live gates, drivers before sinks.
+    std::vector<unsigned int> order() const;
+
+private:
+    using Label = std::uint64_t;
+
+    // Search marks by store index; scratch space that copies do not share.
+    struct Marks
+    {
+        Marks() = default;
+        Marks(const Marks&) {}
+        Marks& operator=(const Marks&) { return *this; }
+
+        std::vector<unsigned char> side;
+    };
+
+    void link(unsigned int index, unsigned int prev, unsigned int next);
+    void unlink(unsigned int index);
+    void moveRun(std::vector<unsigned int>& run, unsigned int after, unsigned int before);
+    void labelRun(unsigned int first, unsigned int last, unsigned int caunt);
+    void clearMarks(const std::vector<unsigned int>& a, const std::vector<unsigned int>& b,
+                    const std::vector<unsigned int>& c, const std::vector<unsigned int>& d);
+
+private:
+    CowVector<Label> label_;
+    CowVector<unsigned int> prev_;
+    CowVector<unsigned int> next_;
+    unsigned int head_ = npos;
+    unsigned int tail_ = npos;
+    unsigned int caunt_ = 0;
+    Marks marks_;
+};
+
+} // namespace doc
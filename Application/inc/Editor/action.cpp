@@ -1,121 +1,147 @@
 #include "action.h"
+#include "packedHistory.h"
 
 
 namespace edt
 {
-    
 
-//////////////////////////////////////////////////////////////
-///Add Edge action
-//////////////////////////////////////////////////////////////    
-AddGate::AddGate(std::shared_ptr<doc::Document> doc, std::shared_ptr<doc::Gate> gate )
+namespace
 {
-    doc_ = doc;
-    gate_ = gate;
+// An action or Gate together with the control block make_shared puts
+// in front of it.
+template<class T>
+constexpr std::size_t sharedSize()
+{
+    return sizeof( T ) + 2 * sizeof( void* );
+}
+
+std::size_t instanceSize( const doc::Instance& instance )
+{
+    return ( instance.inputs.capacity() + instance.outputs.capacity() ) * sizeof( unsigned int )
+           + instance.driverOutputs.capacity();
+}
 }
 
-void AddGate::doo()
+std::size_t fanoutSize( const std::vector<doc::Net>& fanout )
 {
-    doc_->addGate( *gate_ );
+    std::size_t bytes = fanout.capacity() * sizeof( doc::Net );
+    for( const doc::Net& net : fanout ){
+        bytes += net.sinks.capacity() * sizeof( doc::Pin );
+    }
+    return bytes;
 }
 
-std::shared_ptr<IAction> AddGate::returnInversAction()
+void IAction::pack( ActionPacker& packer ) const
 {
-    return std::make_shared<RemovGate>( doc_, gate_ );
+    packer.keep( std::const_pointer_cast<IAction>( shared_from_this() ) );
 }
 
 
 
+
 //////////////////////////////////////////////////////////////
-///Remov Gate action
+///Add Instance action
 //////////////////////////////////////////////////////////////
-RemovGate::RemovGate( std::shared_ptr<doc::Document> doc, std::shared_ptr<doc::Gate> gate )
+AddInstance::AddInstance( std::shared_ptr<doc::Document> doc, doc::Instance instance, unsigned int instanceId,
+                          std::vector<doc::Net> fanout )
 {
     doc_ = doc;
-    gate_ = gate;
+    instance_ = std::move( instance );
+    instanceId_ = instanceId;
+    fanout_ = std::move( fanout );
 }
 
-void RemovGate::doo()
+void AddInstance::doo()
 {
-    doc_->removeaGate( gate_->getId() );
+    // Redo brings the instance back under the same id and wire ids
+    instanceId_ = doc_->addInstance( instance_, instanceId_, fanout_ );
+    instance_ = doc_->instance( instanceId_ );
 }
 
-std::shared_ptr<IAction> RemovGate::returnInversAction()
+std::shared_ptr<IAction> AddInstance::returnInversAction()
 {
-    return std::make_shared<AddGate>( doc_, gate_ );
+    return std::make_shared<RemovInstance>( doc_, instanceId_ );
 }
 
-
-
-
-//////////////////////////////////////////////////////////////
-///Add Edge action
-/////////////////////////////////////////////////////////////
-AddEdge::AddEdge(std::shared_ptr<doc::Gate> gateC, unsigned int port , std::shared_ptr<doc::Gate> gateI )
+unsigned int AddInstance::instanceId() const
 {
-    gateC_ = gateC;
-    gateI_ = gateI;
-    port_ = port;
+    return instanceId_;
 }
 
-void AddEdge::doo()
+std::size_t AddInstance::byteSize() const
 {
-    gateC_->addConect( gateI_->getId() );
-    gateI_->addInput( port_, gateC_->getId());
+    return sharedSize<AddInstance>() + instanceSize( instance_ ) + fanoutSize( fanout_ );
 }
 
-std::shared_ptr<IAction> AddEdge::returnInversAction()
-{
-    return std::make_shared<RemovEdge>( gateC_, port_, gateI_ );
-}
-
-
 
 
 //////////////////////////////////////////////////////////////
-///Remov Edge action
+///Remov Instance action
 //////////////////////////////////////////////////////////////
-RemovEdge::RemovEdge(std::shared_ptr<doc::Gate> gateC, unsigned int port, std::shared_ptr<doc::Gate> gateI )
+RemovInstance::RemovInstance( std::shared_ptr<doc::Document> doc, unsigned int instanceId )
 {
-    gateC_ = gateC;
-    gateI_ = gateI;
-    port_ = port;
+    doc_ = doc;
+    instanceId_ = instanceId;
 }
 
-void RemovEdge::doo()
+void RemovInstance::doo()
 {
-    gateC_->removeConect( gateI_->getId() );
-    gateI_->removeInput( port_ );
+    instance_ = doc_->instance( instanceId_ );
+    fanout_.clear();
+    for( unsigned int wireId : instance_.outputs ){
+        fanout_.push_back( doc_->net( wireId ) );
+    }
+    doc_->removeInstance( instanceId_ );
 }
 
-std::shared_ptr<IAction> RemovEdge::returnInversAction()
+std::shared_ptr<IAction> RemovInstance::returnInversAction()
 {
-    return std::make_shared<AddEdge>( gateC_, port_, gateI_ );
+    return std::make_shared<AddInstance>( doc_, instance_, instanceId_, fanout_ );
 }
 
+std::size_t RemovInstance::byteSize() const
+{
+    return sharedSize<RemovInstance>() + instanceSize( instance_ ) + fanoutSize( fanout_ );
+}
 
+void RemovInstance::pack( ActionPacker& packer ) const
+{
+    packer.op( ActionPacker::Op::RemovInstance );
+    packer.id( instanceId_ );
+}
 
 
 
 //////////////////////////////////////////////////////////////
-///Achange Gate Type action
+///Bind Input action
 //////////////////////////////////////////////////////////////
-ChangeGateType::ChangeGateType( std::shared_ptr<doc::Gate> gate, const std::string& type )
+BindInput::BindInput( std::shared_ptr<doc::Document> doc, unsigned int instanceId, unsigned int port,
+                      unsigned int driverId, unsigned int output )
 {
-    gate_ = gate;
-    type_ = type;
+    doc_ = doc;
+    instanceId_ = instanceId;
+    port_ = port;
+    driverId_ = driverId;
+    output_ = output;
 }
 
-void ChangeGateType::doo()
+void BindInput::doo()
 {
-    std::string firstType = gate_->getType();
-    gate_->setType( type_ );
-    type_ = std::move( firstType );
+    const doc::Instance& instance = doc_->instance( instanceId_ );
+    previousId_ = instance.inputs.at( port_ );
+    previousOutput_ = port_ < instance.driverOutputs.size() ? instance.driverOutputs[port_] : 0;
+    doc_->bindInput( instanceId_, port_, driverId_, output_ );
 }
 
-std::shared_ptr<IAction> ChangeGateType::returnInversAction()
+std::shared_ptr<IAction> BindInput::returnInversAction()
 {
-    return std::make_shared<ChangeGateType>( gate_, type_ );
+    return std::make_shared<BindInput>( doc_, instanceId_, port_, previousId_, previousOutput_ );
 }
 
-} // namespace edt
\ No newline at end of file
+std::size_t BindInput::byteSize() const
+{
+    return sharedSize<BindInput>();
+}
+
+
+} // namespace edt
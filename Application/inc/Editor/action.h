@@ -1,100 +1,95 @@
 #pragma once 
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <vector>
 #include "../Document/document.h"
 namespace edt
 {
+
+class ActionPacker;
+
+// Heap memory of the nets a removed gate or instance drove.
+std::size_t fanoutSize( const std::vector<doc::Net>& fanout );
  
-class IAction
+class IAction : public std::enable_shared_from_this<IAction>
 {
 public:
     virtual ~IAction() = default;
     virtual void doo() = 0;
     virtual std::shared_ptr<IAction> returnInversAction() = 0;
+    // Memory the action keeps alive, roughly; the editor keeps its
+    // history within a budget with it.
+    virtual std::size_t byteSize() const = 0;
+    // Appends the action to a packed history entry. By default the
+    // entry keeps the action itself, which needs it to be owned by a
+    // shared_ptr, as every Boxed action is.
+    virtual void pack( ActionPacker& packer ) const;
 
 };
 
 
 //////////////////////////////////////////////////////////////
-///Add Gate action
+///Add Instance action
 //////////////////////////////////////////////////////////////
-class AddGate : public IAction
+class AddInstance : public IAction
 {
 public:
-    AddGate(std::shared_ptr<doc::Document> doc, std::shared_ptr<doc::Gate> gate );
+    AddInstance( std::shared_ptr<doc::Document> doc, doc::Instance instance, unsigned int instanceId = doc::Gate::NoGate,
+                 std::vector<doc::Net> fanout = {} );
     void doo() override;
     std::shared_ptr<IAction> returnInversAction() override;
+    std::size_t byteSize() const override;
+    unsigned int instanceId() const;
 private:
     std::shared_ptr<doc::Document> doc_;
-    std::shared_ptr<doc::Gate> gate_;
+    doc::Instance instance_;
+    unsigned int instanceId_;
+    // What the wires of a removed instance drove
+    std::vector<doc::Net> fanout_;
 };
- 
 
 
 
 //////////////////////////////////////////////////////////////
-///Remove Gate action
+///Remove Instance action
 //////////////////////////////////////////////////////////////
-class RemovGate : public IAction
+class RemovInstance : public IAction
 {
 public:
-    RemovGate( std::shared_ptr<doc::Document> doc, std::shared_ptr<doc::Gate> gate );
+    RemovInstance( std::shared_ptr<doc::Document> doc, unsigned int instanceId );
     void doo() override;
     std::shared_ptr<IAction> returnInversAction() override;
+    std::size_t byteSize() const override;
+    void pack( ActionPacker& packer ) const override;
 private:
     std::shared_ptr<doc::Document> doc_;
-    std::shared_ptr<doc::Gate> gate_;
-};
- 
-
-
-//////////////////////////////////////////////////////////////
-///Add Edge
-//////////////////////////////////////////////////////////////
-class AddEdge : public IAction
-{
-public:
-    AddEdge( std::shared_ptr<doc::Gate> gateC, unsigned int port, std::shared_ptr<doc::Gate> gateI );
-    void doo() override;
-    std::shared_ptr<IAction> returnInversAction() override;
-private:
-    std::shared_ptr<doc::Gate> gateC_;
-    std::shared_ptr<doc::Gate> gateI_;
-    unsigned int port_;
-};
- 
-
-
-
-//////////////////////////////////////////////////////////////
-///Remove edge action
-//////////////////////////////////////////////////////////////
-class RemovEdge : public IAction
-{
-public:    
-    RemovEdge( std::shared_ptr<doc::Gate> gateC, unsigned int port, std::shared_ptr<doc::Gate> gateI );
-    void doo() override;
-    std::shared_ptr<IAction> returnInversAction() override;
-private:    
-    std::shared_ptr<doc::Gate> gateC_;
-    std::shared_ptr<doc::Gate> gateI_;
-    unsigned int port_;
+    doc::Instance instance_;
+    unsigned int instanceId_;
+    std::vector<doc::Net> fanout_;
 };
 
 
 
 //////////////////////////////////////////////////////////////
-///Achange Gate Type action
+///Bind Input action
 //////////////////////////////////////////////////////////////
-class ChangeGateType : public IAction
+class BindInput : public IAction
 {
 public:
-    ChangeGateType(std::shared_ptr<doc::Gate> gate, const std::string& type);
+    BindInput( std::shared_ptr<doc::Document> doc, unsigned int instanceId, unsigned int port, unsigned int driverId,
+               unsigned int output = 0 );
     void doo() override;
     std::shared_ptr<IAction> returnInversAction() override;
+    std::size_t byteSize() const override;
 private:
-    std::shared_ptr<doc::Gate> gate_;
-    std::string type_;
+    std::shared_ptr<doc::Document> doc_;
+    unsigned int instanceId_;
+    unsigned int port_;
+    unsigned int driverId_;
+    unsigned int output_;
+    unsigned int previousId_ = doc::Gate::NoGate;
+    unsigned int previousOutput_ = 0;
 };
 
 
@@ -0,0 +1,262 @@
+#include "edit.h"
+#include "packedHistory.h"
+
+#include <cassert>
+#include <utility>
+
+namespace edt
+{
+
+namespace
+{
+struct Applier
+{
+    doc::Document* doc;
+    Edit& edit;
+
+    void operator()( op::AddGate& add )
+    {
+        unsigned int id = doc->addGate( add.type, add.inputs, add.outputs, add.id, add.fanout );
+        // The fanout may have grown with sinks that waited for the id.
+        edit = op::RemovGate{ id, add.type, add.inputs, add.outputs, doc->nets( id ) };
+    }
+
+    void operator()( op::RemovGate& remov )
+    {
+        op::AddGate inverse( doc->typeOf( remov.id ) );
+        inverse.id = remov.id;
+        inverse.inputs = doc->inputsOf( remov.id );
+        inverse.outputs = doc->driverOutputsOf( remov.id );
+        inverse.fanout = doc->nets( remov.id );
+        doc->removeaGate( remov.id );
+        edit = std::move( inverse );
+    }
+
+    void operator()( op::AddEdge& add )
+    {
+        unsigned int previousId = doc->driverOf( add.port, add.sinkId );
+        unsigned int previousOutput = doc->driverOutputOf( add.port, add.sinkId );
+        doc->connect( add.driverId, add.port, add.sinkId, add.output );
+        if( previousId != doc::Gate::NoGate ){
+            add.previousId = add.driverId;
+            add.previousOutput = add.output;
+            add.driverId = previousId;
+            add.output = previousOutput;
+            return;
+        }
+        edit = op::RemovEdge{ add.port, add.sinkId, add.driverId, add.output };
+    }
+
+    void operator()( op::RemovEdge& remov )
+    {
+        unsigned int driverId = doc->driverOf( remov.port, remov.sinkId );
+        unsigned int output = doc->driverOutputOf( remov.port, remov.sinkId );
+        doc->disconnect( remov.port, remov.sinkId );
+        remov.driverId = driverId;
+        remov.output = output;
+        if( driverId != doc::Gate::NoGate ){
+            edit = op::AddEdge{ driverId, remov.port, remov.sinkId, output };
+        }
+    }
+
+    void operator()( op::ChangeGateType& change )
+    {
+        doc::GateType type = doc->typeOf( change.gateId );
+        doc->setType( change.gateId, change.type );
+        change.previousType = change.type;
+        change.type = type;
+    }
+
+    void operator()( op::Boxed& boxed )
+    {
+        boxed.action->doo();
+        boxed.action = boxed.action->returnInversAction();
+    }
+};
+
+struct Flipper
+{
+    Edit& edit;
+
+    bool operator()( op::AddGate& add )
+    {
+        edit = op::RemovGate{ add.id, add.type, add.inputs, add.outputs, std::move( add.fanout ) };
+        return true;
+    }
+
+    bool operator()( op::RemovGate& remov )
+    {
+        op::AddGate inverse( remov.type );
+        inverse.id = remov.id;
+        inverse.inputs = remov.inputs;
+        inverse.outputs = remov.outputs;
+        inverse.fanout = std::move( remov.fanout );
+        edit = std::move( inverse );
+        return true;
+    }
+
+    bool operator()( op::AddEdge& add )
+    {
+        if( add.previousId != doc::Gate::NoGate ){
+            std::swap( add.driverId, add.previousId );
+            std::swap( add.output, add.previousOutput );
+            return true;
+        }
+        edit = op::RemovEdge{ add.port, add.sinkId, add.driverId, add.output };
+        return true;
+    }
+
+    // Removing an open port changes nothing either way.
+    bool operator()( op::RemovEdge& remov )
+    {
+        if( remov.driverId != doc::Gate::NoGate ){
+            edit = op::AddEdge{ remov.driverId, remov.port, remov.sinkId, remov.output };
+        }
+        return true;
+    }
+
+    bool operator()( op::ChangeGateType& change )
+    {
+        std::swap( change.type, change.previousType );
+        return true;
+    }
+
+    bool operator()( op::Boxed& )
+    {
+        return false;
+    }
+};
+
+void packGate( ActionPacker& packer, const op::AddGate& add )
+{
+    packer.value( static_cast<unsigned int>( add.type ) );
+    packer.id( add.id );
+    unsigned int connected = 0;
+    for( unsigned int port = 0; port < doc::Gate::MaxInputs; ++port ){
+        if( add.inputs[port] != doc::Gate::NoGate ){
+            connected |= 1u << port;
+        }
+    }
+    packer.value( connected );
+    for( unsigned int port = 0; port < doc::Gate::MaxInputs; ++port ){
+        if( connected & ( 1u << port ) ){
+            packer.id( add.inputs[port] );
+            packer.value( add.outputs[port] );
+        }
+    }
+    packer.value( static_cast<unsigned int>( add.fanout.size() ) );
+    for( const doc::Net& net : add.fanout ){
+        packer.value( net.output );
+        packer.value( static_cast<unsigned int>( net.sinks.size() ) );
+        for( const doc::Pin& sink : net.sinks ){
+            packer.id( sink.gateId );
+            packer.value( sink.port );
+        }
+    }
+}
+}
+
+
+
+namespace op
+{
+
+AddGate::AddGate( doc::GateType type )
+    : id( doc::Gate::NoGate ), type( type )
+{
+    inputs.fill( doc::Gate::NoGate );
+}
+
+AddGate::AddGate( const doc::Gate &gate )
+    : id( gate.getId() ), type( gate.getType() ), inputs( gate.getInputs() ), outputs( gate.getDriverOutputs() )
+{
+}
+
+} // namespace op
+
+
+
+void apply( const std::shared_ptr<doc::Document> &doc, Edit &edit )
+{
+    std::visit( Applier{ doc.get(), edit }, edit );
+}
+
+bool flip( Edit &edit )
+{
+    return std::visit( Flipper{ edit }, edit );
+}
+
+unsigned int gateOf( const Edit &edit )
+{
+    switch( edit.index() ){
+    case 0:
+        return std::get<op::AddGate>( edit ).id;
+    case 1:
+        return std::get<op::RemovGate>( edit ).id;
+    case 2:
+        return std::get<op::AddEdge>( edit ).sinkId;
+    case 3:
+        return std::get<op::RemovEdge>( edit ).sinkId;
+    case 4:
+        return std::get<op::ChangeGateType>( edit ).gateId;
+    }
+    return doc::Gate::NoGate;
+}
+
+std::size_t heapSize( const Edit &edit )
+{
+    switch( edit.index() ){
+    case 0:
+        return fanoutSize( std::get<op::AddGate>( edit ).fanout );
+    case 1:
+        return fanoutSize( std::get<op::RemovGate>( edit ).fanout );
+    case 5:{
+        const op::Boxed& boxed = std::get<op::Boxed>( edit );
+        return boxed.action ? boxed.action->byteSize() : 0;
+    }
+    }
+    return 0;
+}
+
+void pack( ActionPacker &packer, const Edit &edit )
+{
+    switch( edit.index() ){
+    case 0:
+        packer.op( ActionPacker::Op::AddGate );
+        packGate( packer, std::get<op::AddGate>( edit ) );
+        return;
+    case 1:
+        packer.op( ActionPacker::Op::RemovGate );
+        packer.id( std::get<op::RemovGate>( edit ).id );
+        return;
+    case 2:{
+        const op::AddEdge& add = std::get<op::AddEdge>( edit );
+        packer.op( ActionPacker::Op::AddEdge );
+        packer.id( add.driverId );
+        packer.value( add.port );
+        packer.id( add.sinkId );
+        packer.value( add.output );
+        return;
+    }
+    case 3:{
+        const op::RemovEdge& remov = std::get<op::RemovEdge>( edit );
+        packer.op( ActionPacker::Op::RemovEdge );
+        packer.value( remov.port );
+        packer.id( remov.sinkId );
+        return;
+    }
+    case 4:{
+        const op::ChangeGateType& change = std::get<op::ChangeGateType>( edit );
+        packer.op( ActionPacker::Op::ChangeGateType );
+        packer.id( change.gateId );
+        packer.value( static_cast<unsigned int>( change.type ) );
+        return;
+    }
+    }
+    const op::Boxed& boxed = std::get<op::Boxed>( edit );
+    assert( boxed.action );
+    boxed.action->pack( packer );
+}
+
+
+} // namespace edt
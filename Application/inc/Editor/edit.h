@@ -0,0 +1,96 @@
+#pragma once
+
+#include "action.h"
+
+#include <cstddef>
+#include <memory>
+#include <variant>
+#include <vector>
+
+namespace edt
+{
+
+// Primitive edits as plain values keyed by gate ids. Each holds what
+// applying it needs; only the fanout of a removed gate is on the heap.
+// Fields that say what an edit replaced are filled in by apply();
+// flip() reads them.
+namespace op
+{
+
+// Adds the gate under `id`, or a fresh id for Gate::NoGate.
+struct AddGate
+{
+    explicit AddGate( doc::GateType type = doc::GateType::INPUT );
+    explicit AddGate( const doc::Gate& gate );
+
+    unsigned int id;
+    doc::GateType type;
+    doc::Gate::Inputs inputs;
+    doc::Gate::DriverOutputs outputs{};
+    // Nets to reconnect when a removed gate comes back.
+    std::vector<doc::Net> fanout;
+};
+
+struct RemovGate
+{
+    unsigned int id;
+    // The gate as adding it back needs it.
+    doc::GateType type = doc::GateType::INPUT;
+    doc::Gate::Inputs inputs{};
+    doc::Gate::DriverOutputs outputs{};
+    std::vector<doc::Net> fanout{};
+};
+
+struct AddEdge
+{
+    unsigned int driverId;
+    unsigned int port;
+    unsigned int sinkId;
+    unsigned int output = 0;
+    // Driver output the edge replaces, Gate::NoGate for an open port.
+    unsigned int previousId = doc::Gate::NoGate;
+    unsigned int previousOutput = 0;
+};
+
+struct RemovEdge
+{
+    unsigned int port;
+    unsigned int sinkId;
+    unsigned int driverId = doc::Gate::NoGate;
+    unsigned int output = 0;
+};
+
+struct ChangeGateType
+{
+    unsigned int gateId;
+    doc::GateType type;
+    doc::GateType previousType = doc::GateType::INPUT;
+};
+
+// Any other action, e.g. instance edits, which hold a module.
+struct Boxed
+{
+    std::shared_ptr<IAction> action;
+};
+
+} // namespace op
+
+using Edit = std::variant<op::AddGate, op::RemovGate, op::AddEdge, op::RemovEdge, op::ChangeGateType, op::Boxed>;
+
+// Applies the edit and leaves its inverse in its place, so applying it
+// again undoes it. Boxed ignores `doc`. If the document refuses the
+// edit (CycleError, an id in use) nothing changes.
+void apply( const std::shared_ptr<doc::Document>& doc, Edit& edit );
+// Turns an edit apply() left behind into the one applying it would
+// leave, without a document, as if it had been applied. False, and
+// nothing changes, for Boxed edits.
+bool flip( Edit& edit );
+// Gate the edit is about; for an applied AddGate the id the gate got.
+unsigned int gateOf( const Edit& edit );
+// Heap memory the edit holds.
+std::size_t heapSize( const Edit& edit );
+// Boxed edits are packed by their action.
+void pack( ActionPacker& packer, const Edit& edit );
+
+
+} // namespace edt
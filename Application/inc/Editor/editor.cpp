@@ -1,55 +1,459 @@
 #include "editor.h"
 
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
+#include <variant>
 namespace edt
 {
 
+namespace
+{
+// Journal batch of an entry that may have no document.
+class EntryBatch
+{
+public:
+    explicit EntryBatch( const std::shared_ptr<doc::Document>& doc )
+        : doc_( doc.get() )
+    {
+        if( doc_ ){
+            doc_->journal().beginBatch();
+        }
+    }
+
+    ~EntryBatch()
+    {
+        if( doc_ ){
+            doc_->journal().endBatch();
+        }
+    }
+
+    EntryBatch( const EntryBatch& ) = delete;
+    EntryBatch& operator=( const EntryBatch& ) = delete;
+
+private:
+    doc::Document* doc_;
+};
+}
+
 
-Editor &Editor::getEditor(){
-    static Editor editor;
-    return editor;
 
+Editor::Editor(std::shared_ptr<doc::Document> doc)
+    : doc_(std::move(doc))
+    , packed_(doc_)
+{
+}
+
+const std::shared_ptr<doc::Document> &Editor::document() const{
+    return doc_;
 }
 
 
 void Editor::proces(std::shared_ptr<IAction> action){
     action->doo();
-    undo_.push(action->returnInversAction());
-    while(!redo_.empty()){
-        redo_.pop();
-    }
+    procesDone(action);
+}
+
+void Editor::procesDone(std::shared_ptr<IAction> action){
+    record(op::Boxed{ action->returnInversAction() });
+}
+
+unsigned int Editor::proces(Edit edit){
+    edt::apply(doc_, edit);
+    unsigned int gateId = gateOf(edit);
+    record(std::move(edit));
+    return gateId;
 }
 
 void Editor::undo(){
-    if(undo_.empty()){
+    if(inTransaction()){
         return;
     }
-    undo_.top()->doo();
-    redo_.push(undo_.top()->returnInversAction());
-    undo_.pop();
+    if(cursor_ == 0 && !packed_.empty()){
+        // Unpacked edits come in undo order; the ring keeps them in the
+        // reverse.
+        unpackScratch_.clear();
+        packed_.pop(unpackScratch_);
+        for(Edit& edit : unpackScratch_){
+            heapBytes_ += heapSize(edit);
+            ring_.push_front(Slot{ std::move(edit), false, false });
+        }
+        ring_.front().entryStart = true;
+        cursor_ = unpackScratch_.size();
+        ++undoEntries_;
+        --ringEntry_;
+        ringSlot_ -= unpackScratch_.size();
+        unpackScratch_.clear();
+    }
+    if(cursor_ == 0){
+        return;
+    }
+    std::size_t start = cursor_ - 1;
+    while(!ring_[start].entryStart){
+        --start;
+    }
+    {
+        EntryBatch batch(doc_);
+        for(std::size_t index = cursor_; index > start; --index){
+            applySlot(ring_[index - 1]);
+        }
+    }
+    cursor_ = start;
+    --undoEntries_;
+    ++redoEntries_;
 }
 
 void Editor::redo(){
-    if(redo_.empty()){
+    if(cursor_ == ring_.size() || inTransaction()){
         return;
     }
-    redo_.top()->doo();
-    undo_.push(redo_.top()->returnInversAction());
-    redo_.pop();
+    std::size_t end = entryEnd(cursor_);
+    {
+        EntryBatch batch(doc_);
+        for(std::size_t index = cursor_; index < end; ++index){
+            applySlot(ring_[index]);
+        }
+    }
+    cursor_ = end;
+    --redoEntries_;
+    ++undoEntries_;
+    enforceBudget();
 }
 
 void Editor::clear(){
-    while(!redo_.empty()){
-        redo_.pop();
+    if(inTransaction()){
+        throw std::logic_error("Editor: clear inside a transaction");
+    }
+    ring_.clear();
+    cursor_ = 0;
+    undoEntries_ = 0;
+    redoEntries_ = 0;
+    packed_.clear();
+    heapBytes_ = 0;
+    ringEntry_ = 0;
+    ringSlot_ = 0;
+    checkpoints_.clear();
+    checkpointSlots_ = CheckpointSlots;
+}
+
+void Editor::begin(){
+    if(doc_){
+        doc_->journal().beginBatch();
+    }
+    marks_.push_back(transactionSize_);
+}
+
+void Editor::commit(){
+    if(marks_.empty()){
+        return;
+    }
+    marks_.pop_back();
+    if(marks_.empty()){
+        if(transactionSize_ > 0){
+            ++undoEntries_;
+            takeCheckpoint();
+        }
+        transactionSize_ = 0;
+        enforceBudget();
+    }
+    if(doc_){
+        doc_->journal().endBatch();
+    }
+}
+
+void Editor::rollback(){
+    if(marks_.empty()){
+        return;
+    }
+    std::size_t mark = marks_.back();
+    marks_.pop_back();
+    while(transactionSize_ > mark){
+        applySlot(ring_.back());
+        popBack();
+        --transactionSize_;
+    }
+    cursor_ = ring_.size();
+    if(doc_){
+        doc_->journal().endBatch();
+    }
+}
+
+bool Editor::inTransaction() const{
+    return !marks_.empty();
+}
+
+void Editor::setHistoryBudget(std::size_t bytes){
+    budget_ = bytes;
+    enforceBudget();
+}
+
+std::size_t Editor::historyBudget() const{
+    return budget_;
+}
+
+std::size_t Editor::historyBytes() const{
+    std::size_t bytes = ring_.size() * sizeof(Slot) + heapBytes_ + packed_.byteSize();
+    if(!checkpoints_.empty()){
+        bytes += checkpoints_.size() * sizeof(Checkpoint) + newestBytes_ + doc_->detachedBytes() - newestDetached_;
+        for(std::size_t index = 0; index + 1 < checkpoints_.size(); ++index){
+            bytes += checkpoints_[index].bytes;
+        }
+    }
+    return bytes;
+}
+
+std::size_t Editor::undoCaunt() const{
+    return undoEntries_ + packed_.size();
+}
+
+std::size_t Editor::redoCaunt() const{
+    return redoEntries_;
+}
+
+// Cost is counted in slots replayed. Restoring a checkpoint compares
+// only the gates the skipped slots touch, about a quarter of what
+// replaying them costs, and flips the slots in place. Packed entries
+// are only reached by undo.
+void Editor::jumpTo(std::size_t position){
+    if(inTransaction()){
+        return;
+    }
+    position = std::min(position, undoCaunt() + redoCaunt());
+    std::size_t target = ringEntry_ - packed_.size() + position;
+    EntryBatch batch(doc_);
+    if(target >= ringEntry_){
+        // Slot where the target state starts, walking from the cursor.
+        std::size_t targetSlot = cursor_;
+        for(std::size_t entry = currentEntry(); entry < target; ++entry){
+            targetSlot = entryEnd(targetSlot);
+        }
+        for(std::size_t entry = currentEntry(); entry > target; --entry){
+            do{
+                --targetSlot;
+            }while(!ring_[targetSlot].entryStart);
+        }
+        auto distance = [](std::size_t a, std::size_t b){ return a < b ? b - a : a - b; };
+        std::size_t bestCost = distance(cursor_, targetSlot);
+        const Checkpoint* best = nullptr;
+        auto next = std::lower_bound(checkpoints_.begin(), checkpoints_.end(), target,
+                                     [](const Checkpoint& checkpoint, std::size_t entry){ return checkpoint.entry < entry; });
+        for(auto it = next == checkpoints_.begin() ? next : next - 1; it != checkpoints_.end() && it <= next; ++it){
+            std::size_t slot = it->slot - ringSlot_;
+            std::size_t from = std::min(cursor_, slot);
+            std::size_t to = std::max(cursor_, slot);
+            // A skipped slot costs about half a replayed one.
+            std::size_t cost = (to - from) / 2 + it->state.pending.size() + distance(slot, targetSlot);
+            if(cost >= bestCost){
+                continue;
+            }
+            bool flippable = true;
+            for(std::size_t index = from; index < to && flippable; ++index){
+                flippable = ring_[index].flippable;
+            }
+            if(flippable){
+                bestCost = cost;
+                best = &*it;
+            }
+        }
+        if(best){
+            restoreCheckpoint(*best);
+        }
+    }
+    while(currentEntry() > target){
+        undo();
+    }
+    while(currentEntry() < target){
+        redo();
+    }
+}
+
+// A new entry drops the redo side; a transaction is one entry from its
+// first edit on.
+void Editor::record(Edit edit){
+    bool entryStart = !inTransaction() || transactionSize_ == 0;
+    if(entryStart){
+        while(ring_.size() > cursor_){
+            popBack();
+        }
+        redoEntries_ = 0;
+        if(!checkpoints_.empty() && checkpoints_.back().entry > currentEntry()){
+            while(!checkpoints_.empty() && checkpoints_.back().entry > currentEntry()){
+                checkpoints_.pop_back();
+            }
+            measureNewestCheckpoint();
+        }
+    }
+    heapBytes_ += heapSize(edit);
+    bool flippable = !std::holds_alternative<op::Boxed>(edit);
+    ring_.push_back(Slot{ std::move(edit), entryStart, flippable });
+    cursor_ = ring_.size();
+    if(inTransaction()){
+        ++transactionSize_;
+        return;
+    }
+    ++undoEntries_;
+    takeCheckpoint();
+    enforceBudget();
+}
+
+void Editor::applySlot(Slot& slot){
+    heapBytes_ -= heapSize(slot.edit);
+    try{
+        edt::apply(doc_, slot.edit);
+    }catch(...){
+        heapBytes_ += heapSize(slot.edit);
+        throw;
+    }
+    heapBytes_ += heapSize(slot.edit);
+    slot.flippable = !std::holds_alternative<op::Boxed>(slot.edit);
+}
+
+void Editor::popBack(){
+    Slot& slot = ring_.back();
+    heapBytes_ -= heapSize(slot.edit);
+    ring_.pop_back();
+}
+
+void Editor::popFront(){
+    Slot& slot = ring_.front();
+    heapBytes_ -= heapSize(slot.edit);
+    ring_.pop_front();
+}
+
+std::size_t Editor::entryEnd(std::size_t start) const{
+    std::size_t end = start + 1;
+    while(end < ring_.size() && !ring_[end].entryStart){
+        ++end;
+    }
+    return end;
+}
+
+// Oldest first. Checkpoints only make jumps faster, so they go before
+// any undo entry is packed. Every entry packs, an action at worst kept
+// whole, so undo reaches each one that is not dropped.
+void Editor::enforceBudget(){
+    if(budget_ == 0 || inTransaction()){
+        return;
+    }
+    while(historyBytes() > budget_ && !checkpoints_.empty()){
+        checkpoints_.erase(checkpoints_.begin());
+    }
+    while(historyBytes() > budget_ && undoEntries_ > 0){
+        std::size_t end = entryEnd(0);
+        packScratch_.clear();
+        for(std::size_t index = end; index > 0; --index){
+            packScratch_.push_back(ring_[index - 1].edit);
+        }
+        packed_.push(packScratch_);
+        packScratch_.clear();
+        for(std::size_t index = 0; index < end; ++index){
+            popFront();
+        }
+        cursor_ -= end;
+        --undoEntries_;
+        ++ringEntry_;
+        ringSlot_ += end;
+    }
+    while(!checkpoints_.empty() && checkpoints_.front().entry < ringEntry_){
+        checkpoints_.erase(checkpoints_.begin());
+    }
+    while(historyBytes() > budget_ && !packed_.empty()){
+        packed_.dropOldest();
     }
-    while(!undo_.empty()){
-        undo_.pop();
+}
+
+
+std::size_t Editor::currentEntry() const{
+    return ringEntry_ + undoEntries_;
+}
+
+// Past MaxCheckpoints every other one goes and the spacing doubles, so
+// the checkpoints stay spread over the whole history.
+void Editor::takeCheckpoint(){
+    if(!doc_){
+        return;
+    }
+    std::size_t slot = ringSlot_ + cursor_;
+    std::size_t last = checkpoints_.empty() ? ringSlot_ : checkpoints_.back().slot;
+    if(slot < last + checkpointSlots_){
+        return;
+    }
+    checkpoints_.push_back(Checkpoint{ currentEntry(), slot, doc_->checkpoint() });
+    // Only the one before the new checkpoint got a new neighbour, unless
+    // they are thinned out.
+    std::size_t first = checkpoints_.size() < 2 ? 0 : checkpoints_.size() - 2;
+    if(checkpoints_.size() > MaxCheckpoints){
+        std::size_t kept = 0;
+        for(std::size_t index = (checkpoints_.size() - 1) % 2; index < checkpoints_.size(); index += 2){
+            checkpoints_[kept++] = std::move(checkpoints_[index]);
+        }
+        checkpoints_.resize(kept);
+        checkpointSlots_ *= 2;
+        first = 0;
     }
+    for(std::size_t index = first; index + 1 < checkpoints_.size(); ++index){
+        checkpoints_[index].bytes = checkpoints_[index].state.bytesApartFrom(*checkpoints_[index + 1].state.netlist);
+    }
+    measureNewestCheckpoint();
 }
 
-unsigned int Editor::genereytId(){
-    return ithemCaont++;
+// The slots between the cursor and the checkpoint are flipped rather
+// than applied; the document takes the checkpoint state at once.
+void Editor::restoreCheckpoint(const Checkpoint& checkpoint){
+    std::size_t slot = checkpoint.slot - ringSlot_;
+    std::size_t from = std::min(cursor_, slot);
+    std::size_t to = std::max(cursor_, slot);
+    std::vector<unsigned int> touched;
+    touched.reserve(to - from);
+    std::size_t entries = 0;
+    for(std::size_t index = from; index < to; ++index){
+        touched.push_back(gateOf(ring_[index].edit));
+        entries += ring_[index].entryStart;
+    }
+    doc_->restore(checkpoint.state, std::move(touched));
+    measureNewestCheckpoint();
+    for(std::size_t index = from; index < to; ++index){
+        flip(ring_[index].edit);
+    }
+    if(slot < cursor_){
+        undoEntries_ -= entries;
+        redoEntries_ += entries;
+    }else{
+        undoEntries_ += entries;
+        redoEntries_ -= entries;
+    }
+    cursor_ = slot;
+}
+
+// A walk over the chunks, so only when the newest checkpoint is new or
+// replaced or the document jumped; a new one shares every table and
+// costs nothing.
+void Editor::measureNewestCheckpoint(){
+    if(checkpoints_.empty()){
+        return;
+    }
+    newestBytes_ = checkpoints_.back().state.bytesApartFrom(*doc_);
+    newestDetached_ = doc_->detachedBytes();
+}
+
+
+Editor::Transaction::Transaction(Editor& editor)
+    : editor_(editor)
+{
+    editor_.begin();
+}
+
+Editor::Transaction::~Transaction(){
+    if(open_){
+        editor_.rollback();
+    }
+}
+
+void Editor::Transaction::commit(){
+    if(open_){
+        open_ = false;
+        editor_.commit();
+    }
 }
 
 
@@ -1,34 +1,159 @@
 #pragma once
 
 #include "action.h"
+#include "edit.h"
+#include "packedHistory.h"
+#include "ring.h"
 
-#include <stack>
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 namespace edt
 {
-    
-    
 
+
+
+//////////////////////////////////////////////////////////////
+///Editor
+///Undo history of one document. Editors share no state, so each
+///document can be edited on a thread of its own; one editor is used
+///by one thread at a time.
+//////////////////////////////////////////////////////////////
 class Editor{
 public:
-    static Editor& getEditor();
-    
+    // Scoped transaction: begins on construction; rolled back on
+    // destruction unless committed.
+    class Transaction{
+    public:
+        explicit Transaction( Editor& editor );
+        ~Transaction();
+        Transaction( const Transaction& ) = delete;
+        Transaction& operator=( const Transaction& ) = delete;
+        void commit();
+    private:
+        Editor& editor_;
+        bool open_ = true;
+    };
+
+public:
+    explicit Editor( std::shared_ptr<doc::Document> doc );
+    Editor( const Editor& ) = delete;
+    Editor& operator=( const Editor& ) = delete;
+
+    const std::shared_ptr<doc::Document>& document() const;
+
     void proces(std::shared_ptr<IAction> action);
+    // Records an action the caller already carried out, e.g. a drag the
+    // scene showed while it went on.
+    void procesDone( std::shared_ptr<IAction> action );
+    // Value edits need no allocation at all. Returns gateOf() of the
+    // applied edit, e.g. the id an added gate got.
+    unsigned int proces( Edit edit );
     void undo();
     void redo();
     void clear();
-    unsigned int genereytId();
-    
+
+    // Between begin() and the matching commit() processed actions go
+    // into one undo entry and their changes into one journal batch.
+    // Transactions nest; the outermost commit closes the entry.
+    // rollback() undoes what was processed since the matching begin().
+    // undo/redo/clear are not allowed inside a transaction.
+    void begin();
+    void commit();
+    void rollback();
+    bool inTransaction() const;
+
+    // Memory the undo and redo history may take, checkpoints included;
+    // 0, the default, is no limit. Past it the oldest checkpoints go
+    // first, then the oldest undo entries are packed, and once only
+    // packed ones are left the oldest of those are dropped.
+    void setHistoryBudget( std::size_t bytes );
+    std::size_t historyBudget() const;
+    std::size_t historyBytes() const;
+    std::size_t undoCaunt() const;
+    std::size_t redoCaunt() const;
+
+    // Moves to the state where undoCaunt() is `position`, e.g. for a
+    // history slider: 0 is the oldest state kept, undoCaunt() +
+    // redoCaunt() the newest. A jump restores the checkpoint nearest
+    // the target when that is cheaper than replaying up to it.
+    void jumpTo( std::size_t position );
+
+    // Edits recorded between two checkpoints; doubles whenever the
+    // checkpoints are thinned out.
+    static constexpr std::size_t CheckpointSlots = 1024;
+    static constexpr std::size_t MaxCheckpoints = 32;
+
     private:
-    Editor() = default;
-    
-    
+    // One edit of the history, already inverted: applying it crosses
+    // back over the edit it was recorded for.
+    struct Slot
+    {
+        Edit edit;
+        // First edit of an undo entry.
+        bool entryStart = false;
+        // apply() left it, so flip() turns it without a document.
+        // Boxed and unpacked edits are not.
+        bool flippable = false;
+    };
+
+    // Document state after `entry` entries, counted from the first
+    // entry ever recorded; `slot` likewise counts slots.
+    struct Checkpoint
+    {
+        std::size_t entry;
+        std::size_t slot;
+        doc::Document::Checkpoint state;
+        // Memory kept apart from the next newer checkpoint; for the
+        // newest see newestBytes_.
+        std::size_t bytes = 0;
+    };
+
+    void record( Edit edit );
+    void applySlot( Slot& slot );
+    void popBack();
+    void popFront();
+    std::size_t entryEnd( std::size_t start ) const;
+    void enforceBudget();
+    std::size_t currentEntry() const;
+    void takeCheckpoint();
+    void restoreCheckpoint( const Checkpoint& checkpoint );
+    void measureNewestCheckpoint();
+
+
 private:
-    std::stack<std::shared_ptr<IAction>> undo_;
-    std::stack<std::shared_ptr<IAction>> redo_;
-    unsigned int ithemCaont = 0;
-    
+    // [0, cursor_) is undo history, oldest first; [cursor_, size) is
+    // redo history. Undo applies an entry back to front, which turns
+    // every slot into the edit redo applies front to back. Undo
+    // entries older than slot 0 are in packed_.
+    std::shared_ptr<doc::Document> doc_;
+    Ring<Slot> ring_;
+    std::size_t cursor_ = 0;
+    std::size_t undoEntries_ = 0;
+    std::size_t redoEntries_ = 0;
+    PackedHistory packed_;
+    std::vector<Edit> packScratch_;
+    std::vector<Edit> unpackScratch_;
+    // heapSize() of the edits in the ring.
+    std::size_t heapBytes_ = 0;
+    std::size_t budget_ = 0;
+    // Open transaction: its slot caunt and the caunt at each nested
+    // begin().
+    std::size_t transactionSize_ = 0;
+    std::vector<std::size_t> marks_;
+    // Entries and slots before ring slot 0, packed or dropped.
+    std::size_t ringEntry_ = 0;
+    std::size_t ringSlot_ = 0;
+    // Oldest first, all within the ring.
+    std::vector<Checkpoint> checkpoints_;
+    std::size_t checkpointSlots_ = CheckpointSlots;
+    // Memory the newest checkpoint kept apart from the document when it
+    // was last measured, and the document's detachedBytes() then; what
+    // the document detached since is counted on top.
+    std::size_t newestBytes_ = 0;
+    std::size_t newestDetached_ = 0;
+
 };
 
 
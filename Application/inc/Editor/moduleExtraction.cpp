@@ -0,0 +1,66 @@
+#include "moduleExtraction.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+
+namespace edt
+{
+
+std::vector<std::shared_ptr<const doc::Module>> extractModules( Editor& editor, unsigned int minGates,
+                                                                unsigned int minCaunt )
+{
+    const std::shared_ptr<doc::Document>& document = editor.document();
+    std::vector<doc::FoldedCone> cones = doc::findModules( *document, minGates, minCaunt );
+
+    std::vector<std::shared_ptr<const doc::Module>> modules;
+    std::unordered_set<const doc::Module*> seen;
+    for( const doc::FoldedCone& cone : cones ){
+        if( seen.insert( cone.module.get() ).second ){
+            modules.push_back( cone.module );
+        }
+    }
+
+    // Only cone roots are read by instances, and only by instances that
+    // were there before: a cone never reads a later root.
+    std::unordered_multimap<unsigned int, std::pair<unsigned int, unsigned int>> readers;
+    for( unsigned int instanceId : document->instanceIds() ){
+        const std::vector<unsigned int>& inputs = document->instance( instanceId ).inputs;
+        for( unsigned int port = 0; port < inputs.size(); ++port ){
+            readers.emplace( inputs[port], std::make_pair( instanceId, port ) );
+        }
+    }
+
+    Editor::Transaction transaction( editor );
+    std::unordered_map<unsigned int, unsigned int> wireOf;
+    for( const doc::FoldedCone& cone : cones ){
+        doc::Instance instance;
+        instance.module = cone.module;
+        for( std::size_t leaf = 0; leaf < cone.leaves.size(); ++leaf ){
+            auto wire = wireOf.find( cone.leaves[leaf] );
+            bool folded = wire != wireOf.end();
+            instance.inputs.push_back( folded ? wire->second : cone.leaves[leaf] );
+            instance.driverOutputs.push_back( folded ? 0 : cone.leafOutputs[leaf] );
+        }
+        auto add = std::make_shared<AddInstance>( document, std::move( instance ) );
+        editor.proces( add );
+        unsigned int wire = document->instance( add->instanceId() ).outputs.front();
+        doc::Net net = document->net( cone.root );
+        for( const doc::Pin& sink : net.sinks ){
+            editor.proces( op::AddEdge{ wire, sink.port, sink.gateId } );
+        }
+        auto range = readers.equal_range( cone.root );
+        for( auto it = range.first; it != range.second; ++it ){
+            editor.proces( std::make_shared<BindInput>( document, it->second.first, it->second.second, wire ) );
+        }
+        for( unsigned int id : cone.gates ){
+            editor.proces( op::RemovGate{ id } );
+        }
+        wireOf[cone.root] = wire;
+    }
+    transaction.commit();
+    return modules;
+}
+
+} // namespace edt
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "editor.h"
+#include "../Document/module.h"
+
+#include <memory>
+#include <vector>
+
+namespace edt
+{
+
+// Folds the cones doc::findModules() finds in the editor's document as
+// one undo entry: every occurrence becomes an instance whose wire takes
+// over the sinks and instance readers of the cone root, and the cone
+// gates are removed. Returns the new modules.
+std::vector<std::shared_ptr<const doc::Module>> extractModules( Editor& editor, unsigned int minGates = 3,
+                                                                unsigned int minCaunt = 2 );
+
+} // namespace edt
@@ -0,0 +1,258 @@
+#include "packedHistory.h"
+
+#include <utility>
+
+namespace edt
+{
+
+namespace
+{
+unsigned int zigzag( unsigned int delta )
+{
+    return ( delta << 1 ) ^ ( 0u - ( delta >> 31 ) );
+}
+
+unsigned int unzigzag( unsigned int code )
+{
+    return ( code >> 1 ) ^ ( 0u - ( code & 1 ) );
+}
+
+class Reader
+{
+public:
+    Reader( const std::vector<unsigned char>& bytes, std::size_t position )
+        : bytes_( bytes ), position_( position )
+    {
+    }
+
+    unsigned int value()
+    {
+        unsigned int value = 0;
+        for( unsigned int shift = 0; ; shift += 7 ){
+            unsigned char byte = bytes_[position_++];
+            value |= static_cast<unsigned int>( byte & 0x7f ) << shift;
+            if( !( byte & 0x80 ) ){
+                return value;
+            }
+        }
+    }
+
+    unsigned int id()
+    {
+        lastId_ += unzigzag( value() );
+        return lastId_;
+    }
+
+    op::AddGate gate()
+    {
+        op::AddGate add( static_cast<doc::GateType>( value() ) );
+        add.id = id();
+        unsigned int connected = value();
+        for( unsigned int port = 0; port < doc::Gate::MaxInputs; ++port ){
+            if( connected & ( 1u << port ) ){
+                add.inputs[port] = id();
+                add.outputs[port] = static_cast<unsigned char>( value() );
+            }
+        }
+        add.fanout.resize( value() );
+        for( doc::Net& net : add.fanout ){
+            net.driver = add.id;
+            net.output = value();
+            net.sinks.resize( value() );
+            for( doc::Pin& sink : net.sinks ){
+                sink.gateId = id();
+                sink.port = value();
+            }
+        }
+        return add;
+    }
+
+    std::size_t position() const
+    {
+        return position_;
+    }
+
+private:
+    const std::vector<unsigned char>& bytes_;
+    std::size_t position_;
+    unsigned int lastId_ = 0;
+};
+}
+
+
+
+//////////////////////////////////////////////////////////////
+///Action packer
+//////////////////////////////////////////////////////////////
+ActionPacker::ActionPacker( std::vector<unsigned char>& bytes, std::vector<std::shared_ptr<IAction>>& kept )
+    : bytes_( bytes ), kept_( kept )
+{
+}
+
+void ActionPacker::op( Op op )
+{
+    bytes_.push_back( static_cast<unsigned char>( op ) );
+}
+
+void ActionPacker::id( unsigned int id )
+{
+    value( zigzag( id - lastId_ ) );
+    lastId_ = id;
+}
+
+void ActionPacker::value( unsigned int value )
+{
+    while( value >= 0x80 ){
+        bytes_.push_back( static_cast<unsigned char>( value | 0x80 ) );
+        value >>= 7;
+    }
+    bytes_.push_back( static_cast<unsigned char>( value ) );
+}
+
+void ActionPacker::keep( std::shared_ptr<IAction> action )
+{
+    bytes_.push_back( static_cast<unsigned char>( Op::Kept ) );
+    kept_.push_back( std::move( action ) );
+}
+
+
+
+//////////////////////////////////////////////////////////////
+///Packed history
+//////////////////////////////////////////////////////////////
+PackedHistory::PackedHistory( std::shared_ptr<doc::Document> doc )
+    : doc_( std::move( doc ) )
+{
+}
+
+void PackedHistory::push( const std::vector<Edit>& edits )
+{
+    std::size_t keptStart = kept_.size();
+    ActionPacker packer( bytes_, kept_ );
+    for( const Edit& edit : edits ){
+        pack( packer, edit );
+    }
+    for( std::size_t index = keptStart; index < kept_.size(); ++index ){
+        keptBytes_ += kept_[index]->byteSize();
+    }
+    entries_.push_back( Entry{ bytes_.size(), kept_.size() } );
+}
+
+void PackedHistory::pop( std::vector<Edit>& edits )
+{
+    Entry entry = entries_.back();
+    entries_.pop_back();
+    std::size_t begin = entries_.size() > firstEntry_ ? entries_.back().end : firstByte_;
+    std::size_t keptBegin = entries_.size() > firstEntry_ ? entries_.back().keptEnd : firstKept_;
+
+    Reader reader( bytes_, begin );
+    std::size_t kept = keptBegin;
+    while( reader.position() < entry.end ){
+        switch( static_cast<ActionPacker::Op>( reader.value() ) ){
+        case ActionPacker::Op::AddGate:
+            edits.push_back( reader.gate() );
+            break;
+        case ActionPacker::Op::RemovGate:
+            edits.push_back( op::RemovGate{ reader.id() } );
+            break;
+        case ActionPacker::Op::AddEdge:{
+            unsigned int driverId = reader.id();
+            unsigned int port = reader.value();
+            unsigned int sinkId = reader.id();
+            edits.push_back( op::AddEdge{ driverId, port, sinkId, reader.value() } );
+            break;
+        }
+        case ActionPacker::Op::RemovEdge:{
+            unsigned int port = reader.value();
+            edits.push_back( op::RemovEdge{ port, reader.id() } );
+            break;
+        }
+        case ActionPacker::Op::ChangeGateType:{
+            unsigned int gateId = reader.id();
+            edits.push_back( op::ChangeGateType{ gateId, static_cast<doc::GateType>( reader.value() ) } );
+            break;
+        }
+        case ActionPacker::Op::RemovInstance:
+            edits.push_back( op::Boxed{ std::make_shared<RemovInstance>( doc_, reader.id() ) } );
+            break;
+        case ActionPacker::Op::Kept:
+            edits.push_back( op::Boxed{ kept_[kept++] } );
+            break;
+        }
+    }
+    bytes_.resize( begin );
+    releaseKept( keptBegin, kept_.size() );
+    kept_.resize( keptBegin );
+    if( empty() ){
+        clear();
+    }
+}
+
+void PackedHistory::dropOldest()
+{
+    if( empty() ){
+        return;
+    }
+    const Entry& dropped = entries_[firstEntry_++];
+    firstByte_ = dropped.end;
+    releaseKept( firstKept_, dropped.keptEnd );
+    firstKept_ = dropped.keptEnd;
+    if( empty() ){
+        clear();
+        return;
+    }
+    // Erase the dropped prefix once it is most of the array.
+    if( firstEntry_ > 64 && firstEntry_ * 2 > entries_.size() ){
+        for( Entry& entry : entries_ ){
+            entry.end -= firstByte_;
+            entry.keptEnd -= firstKept_;
+        }
+        entries_.erase( entries_.begin(), entries_.begin() + firstEntry_ );
+        bytes_.erase( bytes_.begin(), bytes_.begin() + firstByte_ );
+        kept_.erase( kept_.begin(), kept_.begin() + firstKept_ );
+        bytes_.shrink_to_fit();
+        entries_.shrink_to_fit();
+        firstEntry_ = 0;
+        firstByte_ = 0;
+        firstKept_ = 0;
+    }
+}
+
+void PackedHistory::clear()
+{
+    bytes_ = std::vector<unsigned char>();
+    entries_ = std::vector<Entry>();
+    kept_ = std::vector<std::shared_ptr<IAction>>();
+    firstEntry_ = 0;
+    firstByte_ = 0;
+    firstKept_ = 0;
+    keptBytes_ = 0;
+}
+
+bool PackedHistory::empty() const
+{
+    return size() == 0;
+}
+
+std::size_t PackedHistory::size() const
+{
+    return entries_.size() - firstEntry_;
+}
+
+std::size_t PackedHistory::byteSize() const
+{
+    return bytes_.size() - firstByte_ + size() * sizeof( Entry )
+           + ( kept_.size() - firstKept_ ) * sizeof( std::shared_ptr<IAction> ) + keptBytes_;
+}
+
+// Dropped actions are freed now, not when the prefix is erased.
+void PackedHistory::releaseKept( std::size_t from, std::size_t to )
+{
+    for( std::size_t index = from; index < to; ++index ){
+        keptBytes_ -= kept_[index]->byteSize();
+        kept_[index].reset();
+    }
+}
+
+
+} // namespace edt
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "edit.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace edt
+{
+
+
+//////////////////////////////////////////////////////////////
+///Action packer
+///Writes actions into the current entry of a packed history: an
+///opcode and varint fields per primitive edit. Gate ids are coded as
+///the difference to the previous id of the entry, so the ids of a bulk
+///edit, which mostly run in sequence, take a byte or two. An action
+///with no packed form is kept whole next to the bytes.
+//////////////////////////////////////////////////////////////
+class ActionPacker
+{
+public:
+    enum class Op : unsigned char
+    {
+        AddGate,
+        RemovGate,
+        AddEdge,
+        RemovEdge,
+        ChangeGateType,
+        RemovInstance,
+        Kept
+    };
+
+public:
+    ActionPacker( std::vector<unsigned char>& bytes, std::vector<std::shared_ptr<IAction>>& kept );
+
+    void op( Op op );
+    void id( unsigned int id );
+    void value( unsigned int value );
+    // Adds the action as it is.
+    void keep( std::shared_ptr<IAction> action );
+
+private:
+    std::vector<unsigned char>& bytes_;
+    std::vector<std::shared_ptr<IAction>>& kept_;
+    unsigned int lastId_ = 0;
+};
+
+
+
+//////////////////////////////////////////////////////////////
+///Packed history
+///A stack of undo entries in packed form, oldest first in one byte
+///array. An entry costs a few bytes per edit instead of a ring slot
+///each; it is unpacked into edits again when it is popped. Actions
+///with no packed form (AddInstance holds a module, a scene move its
+///scene) are kept whole and still spare their ring slot. All entries
+///are edits of the one document the history is made for.
+//////////////////////////////////////////////////////////////
+class PackedHistory
+{
+public:
+    explicit PackedHistory( std::shared_ptr<doc::Document> doc );
+
+    // Edits in the order they are applied; every edit packs.
+    void push( const std::vector<Edit>& edits );
+    // Unpacks the newest entry into `edits`, in the order they are
+    // applied, and removes it.
+    void pop( std::vector<Edit>& edits );
+    void dropOldest();
+    void clear();
+
+    bool empty() const;
+    std::size_t size() const;
+    std::size_t byteSize() const;
+
+private:
+    struct Entry
+    {
+        std::size_t end;
+        std::size_t keptEnd;
+    };
+
+    void releaseKept( std::size_t from, std::size_t to );
+
+    std::shared_ptr<doc::Document> doc_;
+    std::vector<unsigned char> bytes_;
+    std::vector<Entry> entries_;
+    std::vector<std::shared_ptr<IAction>> kept_;
+    // Entries, bytes and kept actions before these are dropped; erased
+    // in bulk.
+    std::size_t firstEntry_ = 0;
+    std::size_t firstByte_ = 0;
+    std::size_t firstKept_ = 0;
+    // byteSize() of the kept actions.
+    std::size_t keptBytes_ = 0;
+};
+
+
+} // namespace edt
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace edt
+{
+
+
+//////////////////////////////////////////////////////////////
+///Ring
+///Double-ended queue in one contiguous power-of-two array. Pushing and
+///popping at either end move no other element and allocate only when
+///the array doubles. Popped elements are reset to T() so they release
+///what they hold.
+//////////////////////////////////////////////////////////////
+template<class T>
+class Ring
+{
+public:
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    std::size_t capacity() const
+    {
+        return items_.size();
+    }
+
+    T& operator[]( std::size_t index )
+    {
+        return items_[( head_ + index ) & ( items_.size() - 1 )];
+    }
+
+    const T& operator[]( std::size_t index ) const
+    {
+        return items_[( head_ + index ) & ( items_.size() - 1 )];
+    }
+
+    T& front()
+    {
+        return ( *this )[0];
+    }
+
+    T& back()
+    {
+        return ( *this )[size_ - 1];
+    }
+
+    void push_back( T item )
+    {
+        if( size_ == items_.size() ){
+            grow();
+        }
+        ++size_;
+        back() = std::move( item );
+    }
+
+    void push_front( T item )
+    {
+        if( size_ == items_.size() ){
+            grow();
+        }
+        head_ = ( head_ + items_.size() - 1 ) & ( items_.size() - 1 );
+        ++size_;
+        front() = std::move( item );
+    }
+
+    void pop_back()
+    {
+        back() = T();
+        --size_;
+    }
+
+    void pop_front()
+    {
+        front() = T();
+        head_ = ( head_ + 1 ) & ( items_.size() - 1 );
+        --size_;
+    }
+
+    void clear()
+    {
+        items_ = std::vector<T>();
+        head_ = 0;
+        size_ = 0;
+    }
+
+private:
+    void grow()
+    {
+        std::vector<T> items( items_.empty() ? 16 : items_.size() * 2 );
+        for( std::size_t index = 0; index < size_; ++index ){
+            items[index] = std::move( ( *this )[index] );
+        }
+        items_.swap( items );
+        head_ = 0;
+    }
+
+private:
+    std::vector<T> items_;
+    std::size_t head_ = 0;
+    std::size_t size_ = 0;
+};
+
+
+} // namespace edt
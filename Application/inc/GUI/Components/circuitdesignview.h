@@ -34,7 +34,6 @@ public slots:
 signals:
     // Signal emitted when scene changes, to update undo/redo actions
     void sceneChanged();
-    void addGate( const QString& gateType );
     
 private:
     CustomGraphicsScene* m_scene;
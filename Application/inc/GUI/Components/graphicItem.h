@@ -31,12 +31,12 @@ public:
     QRectF boundingRect() const override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
     
-    // Get item ID
+    // Document gate id this item shows, -1 until the item is bound
     qint64 id() const;
+    void setId(qint64 gateId);
 
 protected:
     void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
-    void mouseMoveEvent(QGraphicsSceneMouseEvent *event) override;
     void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
     void mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event) override; 
     QVariant itemChange(GraphicsItemChange change, const QVariant &value) override;
@@ -65,9 +65,8 @@ private:
     void showContextMenu(const QPointF &screenPos);
     void showNumberInputDialog();
 
+    qint64 m_gateId;
     qreal m_scale;
-    QPointF m_lastMousePos;
-    bool m_isDragging;
     
     // Right button press tracking
     QTimer m_rightButtonTimer;
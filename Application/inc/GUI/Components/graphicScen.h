@@ -8,13 +8,21 @@
 #include <QWidget>
 #include <QVBoxLayout>
 #include <QPushButton>
+#include <QPointer>
+#include <QTimer>
 
-#include <unordered_map>
-#include <string>
+#include <array>
+#include <deque>
+#include <map>
+#include <utility>
 #include <vector>
 
 #include "graphicItem.h"
 #include "connectLine.h"
+#include "../../Editor/action.h"
+#include "../../Document/changeJournal.h"
+#include "../../Document/gateType.h"
+#include "../../Document/slotMap.h"
 
 namespace gui
 {
@@ -56,11 +64,20 @@ public:
     ConnectionLine* addConnectionLine(const QPointF& startPos, const QPointF& endPos);
     // Add a graphics item with specified coordinates and type
     AGraphicsItem* addScalableItemAtPosition(const QString& gateType, const QPointF& pos);
+    // Attach an item to its document gate id; lookups are a slot index into a vector
+    void bindItem(AGraphicsItem* item, qint64 gateId);
+    AGraphicsItem* itemById(qint64 gateId) const;
+    // Moves the bound items and the unbound ones by `delta`, and their
+    // selection rects with them
+    void moveItems(const std::vector<qint64>& gateIds, const std::vector<QPointer<AGraphicsItem>>& unbound, const QPointF& delta);
 
 public slots:
     AGraphicsItem* addScalableItem(const QString &gateType);
     void scaleUpSelected();
     void scaleDownSelected();
+    // Keeps the items and lines in step with the document: gates and
+    // edges it adds or removes (e.g. by undo or redo)
+    void applyChanges(const doc::ChangeBatch& changes);
 
 signals:
     // Signals for selections and connections
@@ -83,13 +100,27 @@ private slots:
     // Methods to update selection rectangles
     void updateSelectionRects();
     void clearSelectionRects();
+    void unbindItem(qint64 gateId);
+    // Shows the drag offset reached since the last frame
+    void showDragFrame();
 
 private:
     void initGateMap();
     AGraphicsItem* itemAtPosition(const QPointF& pos);
+    void beginDrag(AGraphicsItem* item, const QPointF& scenePos);
+    void endDrag();
+    void showGate(const doc::Change& change);
+    void hideGate(const doc::Change& change);
+    void showEdge(const doc::Change& change);
+    void hideEdge(const doc::Change& change);
+    // Hands a drawn line to the document; the edge it adds takes the line over
+    void commitLine(ConnectionLine* line);
 
 private:
-    std::unordered_map<std::string, AGraphicsItem*> gateMap;
+    // Prototype item per gate kind, indexed by doc::GateType.
+    std::array<AGraphicsItem*, doc::GateTypeCaunt> gateMap{};
+    // Items by slot index of their gate id
+    std::vector<AGraphicsItem*> m_itemsBySlot;
     
     // For line drawing with right button
     bool m_rightButtonDown;
@@ -99,6 +130,52 @@ private:
     
     // For selection rectangles
     QList<SelectionRect*> m_selectionRects;
+
+    // Lines of the document edges by sink gate id and input port
+    std::map<std::pair<unsigned int, unsigned char>, QPointer<ConnectionLine>> m_edgeLines;
+    // The line being handed to the document, taken over by its edge
+    ConnectionLine* m_committingLine = nullptr;
+    // Where the items of the last removed gates stood, for when they
+    // come back; the oldest are forgotten past the cap
+    static constexpr std::size_t REMOVED_POS_CAP = 1 << 16;
+    std::map<unsigned int, QPointF> m_removedPos;
+    std::deque<unsigned int> m_removedOrder;
+
+    // A left-button drag moves the whole selection. Mouse moves only
+    // update the target offset; the items follow once per frame and the
+    // gesture is one undo step.
+    static constexpr int DRAG_FRAME_MS = 16;
+    // Bound items are dragged by gate id, so that the move still finds
+    // them once undo and redo have made them anew; unbound ones by pointer.
+    bool m_dragging = false;
+    std::vector<qint64> m_dragIds;
+    std::vector<QPointer<AGraphicsItem>> m_dragUnbound;
+    QPointF m_dragStart;
+    QPointF m_dragTarget;
+    QPointF m_dragShown;
+    QTimer m_dragFrameTimer;
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////////////
+///Move items action
+///Moves scene items by one offset. Positions live in the scene only, so
+///the action touches no document.
+/////////////////////////////////////////////////////////////////////////////////
+class MoveItems : public edt::IAction
+{
+public:
+    MoveItems(CustomGraphicsScene* scene, std::vector<qint64> gateIds, std::vector<QPointer<AGraphicsItem>> unbound, const QPointF& delta);
+    void doo() override;
+    std::shared_ptr<edt::IAction> returnInversAction() override;
+    std::size_t byteSize() const override;
+
+private:
+    QPointer<CustomGraphicsScene> m_scene;
+    std::vector<qint64> m_gateIds;
+    std::vector<QPointer<AGraphicsItem>> m_unbound;
+    QPointF m_delta;
 };
 
 } // namespace gui
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once 
 #include <QMainWindow>
+#include <QLabel>
 #include <QList>
 #include "./Components/dockWidget.h"
 #include "./Components/fileDialog.h"
@@ -29,6 +30,7 @@ private slots:
     void zoomH(const QString& eventName);
     void addLogicGate(const QString &gateType);
     void updateUndoRedoActions();
+    void updateHistoryStatus();
     void redoActions(const QString& actionName);
     void conectFiltr ( const QPointF &sourcePoint, const QPointF &targetPoint );
     
@@ -48,6 +50,8 @@ private:
 
     // New central widget
     CircuitDesignView *circuitView;
+    // Undo history memory against its budget
+    QLabel *historyLabel;
 };
     
 
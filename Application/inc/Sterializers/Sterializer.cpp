@@ -1,16 +1,23 @@
 #include "Sterializer.h"
+#include <algorithm>
 #include <fstream>
 #include <memory>
 #include <iostream>
+#include <utility>
 
 void Sterializer::save(const std::string &path, std::shared_ptr<doc::Document> doc)
+{
+    save(path, *doc, doc->getGateCaunt());
+}
+
+void Sterializer::save(const std::string &path, const doc::Netlist &netlist, unsigned int gateCaunt)
 {
     boost::json::array jsonArray;
-    boost::json::object gateCaunt;
-    gateCaunt["gate caunt"] = doc->getGateCaunt();
-    jsonArray.push_back(gateCaunt);
-    for (auto el : *doc) {
-        jsonArray.push_back(gateToJson(el.second));
+    boost::json::object gateCauntObj;
+    gateCauntObj["gate caunt"] = gateCaunt;
+    jsonArray.push_back(gateCauntObj);
+    for (boost::json::value& value : netlistToJson(netlist)) {
+        jsonArray.push_back(std::move(value));
     }
 
     std::string jsonString = boost::json::serialize(jsonArray);
@@ -18,9 +25,12 @@ void Sterializer::save(const std::string &path, std::shared_ptr<doc::Document> d
     std::ofstream outFile(path);
     outFile << jsonString;
     outFile.close();
+    if (outFile.fail()) {
+        throw std::runtime_error("Could not write file\n");
+    }
 }
 
-std::shared_ptr<doc::Document> Sterializer::open(const std::string &path)
+std::shared_ptr<doc::Document> Sterializer::open(const std::string &path, std::shared_ptr<doc::Arena> arena)
 {
     std::ifstream file(path);
     if (!file.is_open()) {
@@ -32,50 +42,197 @@ std::shared_ptr<doc::Document> Sterializer::open(const std::string &path)
     file.close();
 
     boost::json::value jv = boost::json::parse(json_str);
-    boost::json::array json_array = jv.as_array();
-    boost::json::object obj = jv.as_object();
-    unsigned int gateCaunt = obj["gate caunt"].as_uint64();
+    opening_.push_back(path);
+    std::shared_ptr<doc::Document> doc = jsonToDocument(jv.as_array(), std::move(arena));
+    opening_.pop_back();
+    return doc;
+}
 
-    std::shared_ptr<doc::Document> doc = std::make_shared<doc::Document>();
-    doc->setgateCaunt(gateCaunt);
+// Module entries come before the instances that use them; their
+// numbers count within the array, a module body has its own.
+boost::json::array Sterializer::netlistToJson(const doc::Netlist &netlist)
+{
+    boost::json::array jsonArray;
+    std::map<const doc::Module*, unsigned int> modules;
+    std::vector<unsigned int> instanceIds = netlist.instanceIds();
+    for (unsigned int instanceId : instanceIds) {
+        const std::shared_ptr<const doc::Module>& module = netlist.instance(instanceId).module;
+        if (modules.count(module.get())) {
+            continue;
+        }
+        unsigned int number = modules.size();
+        modules[module.get()] = number;
+        boost::json::object moduleObj;
+        moduleObj["module"] = number;
+        moduleObj["name"] = module->name();
+        if (module->path().empty()) {
+            moduleObj["body"] = netlistToJson(module->body());
+        } else {
+            moduleObj["path"] = module->path();
+        }
+        jsonArray.push_back(moduleObj);
+    }
+
+    for (const doc::Gate& gate : netlist) {
+        jsonArray.push_back(gateToJson(gate));
+    }
 
-    for (const auto& inner_array : json_array) {
-        std::shared_ptr<doc::Gate> gate = jsonToGate(inner_array.as_object());
-        doc->addGate(*gate);
+    for (unsigned int instanceId : instanceIds) {
+        const doc::Instance& instance = netlist.instance(instanceId);
+        boost::json::object instanceObj;
+        instanceObj["instance"] = instanceId;
+        instanceObj["module"] = modules[instance.module.get()];
+        boost::json::object inputsObj;
+        for (unsigned int port = 0; port < instance.inputs.size(); ++port) {
+            if (instance.inputs[port] != doc::Gate::NoGate) {
+                inputsObj[std::to_string(port)] = instance.inputs[port];
+            }
+        }
+        instanceObj["inputs"] = inputsObj;
+        boost::json::object driverOutputsObj;
+        for (unsigned int port = 0; port < instance.driverOutputs.size(); ++port) {
+            if (instance.driverOutputs[port] != 0) {
+                driverOutputsObj[std::to_string(port)] = instance.driverOutputs[port];
+            }
+        }
+        if (!driverOutputsObj.empty()) {
+            instanceObj["driverOutputs"] = driverOutputsObj;
+        }
+        boost::json::array outputsArray;
+        for (unsigned int wireId : instance.outputs) {
+            outputsArray.push_back(wireId);
+        }
+        instanceObj["outputs"] = outputsArray;
+        jsonArray.push_back(instanceObj);
+    }
+    return jsonArray;
+}
+
+std::shared_ptr<doc::Document> Sterializer::jsonToDocument(const boost::json::array &jsonArray, std::shared_ptr<doc::Arena> arena)
+{
+    doc::DocumentBuilder builder;
+    builder.reserve(jsonArray.size(), jsonArray.size() * 2);
+    unsigned int gateCaunt = 0;
+    std::vector<std::shared_ptr<const doc::Module>> modules;
+
+    for (const auto& inner_array : jsonArray) {
+        const boost::json::object& obj = inner_array.as_object();
+        // The first element holds the gate caunt, the rest are modules,
+        // gates and instances
+        if (obj.contains("gate caunt")) {
+            gateCaunt = obj.at("gate caunt").as_uint64();
+            continue;
+        }
+        if (obj.contains("instance")) {
+            doc::Instance instance;
+            std::size_t number = obj.at("module").as_uint64();
+            if (number >= modules.size() || !modules[number]) {
+                throw std::runtime_error("Instance of an unknown module\n");
+            }
+            instance.module = modules[number];
+            instance.inputs.assign(instance.module->inputCaunt(), doc::Gate::NoGate);
+            for (const auto& [key, value] : obj.at("inputs").as_object()) {
+                unsigned int port = std::stoul(std::string(key));
+                if (port < instance.inputs.size()) {
+                    instance.inputs[port] = static_cast<unsigned int>(value.as_uint64());
+                }
+            }
+            instance.driverOutputs.assign(instance.inputs.size(), 0);
+            if (const boost::json::value* driverOutputs = obj.if_contains("driverOutputs")) {
+                for (const auto& [key, value] : driverOutputs->as_object()) {
+                    unsigned int port = std::stoul(std::string(key));
+                    if (port < instance.driverOutputs.size()) {
+                        instance.driverOutputs[port] = static_cast<unsigned char>(value.as_uint64());
+                    }
+                }
+            }
+            for (const boost::json::value& wire : obj.at("outputs").as_array()) {
+                instance.outputs.push_back(static_cast<unsigned int>(wire.as_uint64()));
+            }
+            builder.addInstance(std::move(instance), static_cast<unsigned int>(obj.at("instance").as_uint64()));
+            continue;
+        }
+        if (obj.contains("module")) {
+            std::size_t number = obj.at("module").as_uint64();
+            std::string name(obj.at("name").as_string().c_str());
+            if (number >= modules.size()) {
+                modules.resize(number + 1);
+            }
+            if (obj.contains("path")) {
+                modules[number] = openModule(std::string(obj.at("path").as_string().c_str()), name);
+            } else {
+                modules[number] = std::make_shared<const doc::Module>(name, jsonToDocument(obj.at("body").as_array(), nullptr)->snapshot());
+            }
+            continue;
+        }
+        std::shared_ptr<doc::Gate> gate = jsonToGate(obj);
+        if (gate) {
+            builder.addGate(*gate);
+        }
     }
 
+    std::shared_ptr<doc::Document> doc = builder.build(std::move(arena));
+    doc->setgateCaunt(gateCaunt);
     return doc;
 }
 
+std::shared_ptr<const doc::Module> Sterializer::openModule(const std::string &path, const std::string &name)
+{
+    auto it = modules_.find(path);
+    if (it != modules_.end()) {
+        return it->second;
+    }
+    if (std::find(opening_.begin(), opening_.end(), path) != opening_.end()) {
+        throw std::runtime_error("Module contains itself: " + path + "\n");
+    }
+    std::shared_ptr<const doc::Module> module = std::make_shared<const doc::Module>(name, open(path)->snapshot(), path);
+    modules_[path] = module;
+    return module;
+}
+
 /*
-    std::unordered_map<unsigned int, unsigned int> inputs;
-    std::unordered_set<unsigned int> conects;
-    std::string type;
+    std::array<unsigned int, MaxInputs> inputs;
+    SmallVector<unsigned int, 4> conects;
+    GateType type;
     unsigned int id;
 */
 
-boost::json::object Sterializer::gateToJson( doc::Gate &gate)
+boost::json::object Sterializer::gateToJson(const doc::Gate &gate)
 {
     boost::json::object jsonObj;
 
     jsonObj["id"] = gate.getId();
-    jsonObj["type"] = gate.getType();
+    jsonObj["type"] = doc::gateTypeName(gate.getType());
     boost::json::object conectsObj;
-    std::unordered_set<unsigned int>& conects = gate.getConects();
+    const doc::Gate::Conects& conects = gate.getConects();
     
     int i = 1;
     for(auto el : conects){
-        conectsObj[std::to_string(i)] = el;
+        conectsObj[std::to_string(i++)] = el;
     }
     jsonObj["conects"] = conectsObj;
     
     boost::json::object inputsObj;
-    std::unordered_map<unsigned int, unsigned int>& inputs = gate.getInputs();
-    for(auto el : inputs){
-        inputsObj[std::to_string(el.first)] = el.second;
+    const doc::Gate::Inputs& inputs = gate.getInputs();
+    for(unsigned int port = 0; port < inputs.size(); ++port){
+        if(inputs[port] != doc::Gate::NoGate){
+            inputsObj[std::to_string(port)] = inputs[port];
+        }
     }
     jsonObj["inputs"] = inputsObj;
 
+    // Only ports reading another output than the first are listed.
+    boost::json::object driverOutputsObj;
+    const doc::Gate::DriverOutputs& driverOutputs = gate.getDriverOutputs();
+    for(unsigned int port = 0; port < driverOutputs.size(); ++port){
+        if(inputs[port] != doc::Gate::NoGate && driverOutputs[port] != 0){
+            driverOutputsObj[std::to_string(port)] = driverOutputs[port];
+        }
+    }
+    if(!driverOutputsObj.empty()){
+        jsonObj["driverOutputs"] = driverOutputsObj;
+    }
+
     return jsonObj;    
 }
 
@@ -85,18 +242,19 @@ std::shared_ptr<doc::Gate> Sterializer::jsonToGate(const boost::json::object &ob
 {
     if(obj.find("id") != nullptr)
     {
-        std::unordered_set<unsigned int> conects;
-        std::unordered_map<unsigned int, unsigned int> inputs;
+        doc::Gate::Conects conects;
+        doc::Gate::Inputs inputs;
+        inputs.fill(doc::Gate::NoGate);
 
-        int id = obj.at("id").as_uint64(); 
-        std::string type =  std::string(obj.at("type").as_string().c_str());
+        unsigned int id = obj.at("id").as_uint64();
+        doc::GateType type = doc::gateTypeFromName(std::string(obj.at("type").as_string().c_str()));
 
         boost::json::object conectsObj = obj.at("conects").as_object();
         for(auto el : conectsObj)
         {
             if(el.value().is_uint64())
             {
-                conects.emplace(el.value().as_uint64());
+                conects.push_back(el.value().as_uint64());
             }
         }
 
@@ -104,8 +262,10 @@ std::shared_ptr<doc::Gate> Sterializer::jsonToGate(const boost::json::object &ob
         for (const auto& [key, value] : inputsObj) {
             try {
                 unsigned int keyInt = std::stoul(std::string(key));
-                if (value.is_uint64()) {
-                    inputs.emplace(keyInt, static_cast<unsigned int>(value.as_uint64()));
+                if (keyInt >= inputs.size()) {
+                    std::cerr << "Warning: Input port out of range ignored: " << key << std::endl;
+                } else if (value.is_uint64()) {
+                    inputs[keyInt] = static_cast<unsigned int>(value.as_uint64());
                 } else {
                     std::cerr << "Warning: Non-uint64 value in 'inputs' ignored: " << key << std::endl;
                 }
@@ -113,11 +273,24 @@ std::shared_ptr<doc::Gate> Sterializer::jsonToGate(const boost::json::object &ob
                 std::cerr << "Error converting key '" << key << "' to unsigned int: " << e.what() << std::endl;
             }
         }
+        doc::Gate::DriverOutputs driverOutputs{};
+        if (const boost::json::value* outputsValue = obj.if_contains("driverOutputs")) {
+            for (const auto& [key, value] : outputsValue->as_object()) {
+                unsigned int port = std::stoul(std::string(key));
+                if (port >= driverOutputs.size() || !value.is_uint64() || value.as_uint64() >= doc::MaxGateOutputs) {
+                    std::cerr << "Warning: Driver output ignored: " << key << std::endl;
+                } else {
+                    driverOutputs[port] = static_cast<unsigned char>(value.as_uint64());
+                }
+            }
+        }
         std::shared_ptr<doc::Gate> gate = std::make_shared<doc::Gate>();
         gate->setType(type);
         gate->setId(id);
         gate->setConects(std::move(conects));
-        gate->setInputs(std::move(inputs));
+        gate->setInputs(inputs);
+        gate->setDriverOutputs(driverOutputs);
+        return gate;
     }
     return nullptr;
 }
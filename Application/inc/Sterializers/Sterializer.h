@@ -2,19 +2,39 @@
 
 
 #include "../Document/document.h"
+#include "../Document/documentBuilder.h"
+#include "../Document/module.h"
 
 #include <boost/json.hpp>
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 class Sterializer{
 public:
     Sterializer() = default;
     void save( const std::string& path, std::shared_ptr<doc::Document> doc );
-    std::shared_ptr<doc::Document> open(const std::string& path);
+    // Same for a snapshot, e.g. on a background thread.
+    void save( const std::string& path, const doc::Netlist& netlist, unsigned int gateCaunt );
+    // The document lives in `arena` if given, e.g. a mapped one for a
+    // design larger than memory. Modules its instances refer to by path
+    // are opened too, each file once.
+    std::shared_ptr<doc::Document> open(const std::string& path, std::shared_ptr<doc::Arena> arena = nullptr);
 
 private:
-    boost::json::object gateToJson(doc::Gate& gate);
+    // Instances are saved with their port binding and wires; a module
+    // loaded from a file by its path, one built in memory with its body.
+    boost::json::array netlistToJson(const doc::Netlist& netlist);
+    std::shared_ptr<doc::Document> jsonToDocument(const boost::json::array& jsonArray, std::shared_ptr<doc::Arena> arena);
+    std::shared_ptr<const doc::Module> openModule(const std::string& path, const std::string& name);
+    boost::json::object gateToJson(const doc::Gate& gate);
     std::shared_ptr<doc::Gate> jsonToGate(const boost::json::object& obj);
 
+    // Modules opened so far, by path.
+    std::map<std::string, std::shared_ptr<const doc::Module>> modules_;
+    // Files being opened, to catch a module that contains itself.
+    std::vector<std::string> opening_;
+
 };
 
@@ -0,0 +1,743 @@
+#include "editLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+namespace fs = std::filesystem;
+
+const char Magic[8] = { 'L', 'S', 'E', 'D', 'I', 'T', 'S', '2' };
+// Frame: payload size and checksum, 4 bytes each, then the payload.
+const std::size_t FrameHeader = 8;
+
+void syncFile( std::FILE* file )
+{
+    if( std::fflush( file ) != 0 ){
+        throw std::runtime_error( "EditLog: write failed" );
+    }
+#ifdef _WIN32
+    _commit( _fileno( file ) );
+#else
+    fsync( fileno( file ) );
+#endif
+}
+
+// Syncs a file the saver wrote.
+void syncPath( const std::string& path )
+{
+    std::FILE* file = std::fopen( path.c_str(), "ab" );
+    if( !file ){
+        throw std::runtime_error( "EditLog: " + path + " was not written" );
+    }
+    syncFile( file );
+    std::fclose( file );
+}
+
+std::uint32_t checksum( const unsigned char* bytes, std::size_t size )
+{
+    std::uint32_t hash = 2166136261u;
+    for( std::size_t i = 0; i < size; ++i ){
+        hash = ( hash ^ bytes[i] ) * 16777619u;
+    }
+    return hash;
+}
+
+void putWord( std::vector<unsigned char>& bytes, std::size_t at, std::uint32_t word )
+{
+    for( unsigned int k = 0; k < 4; ++k ){
+        bytes[at + k] = static_cast<unsigned char>( word >> ( 8 * k ) );
+    }
+}
+
+std::uint32_t getWord( const unsigned char* bytes )
+{
+    std::uint32_t word = 0;
+    for( unsigned int k = 0; k < 4; ++k ){
+        word |= static_cast<std::uint32_t>( bytes[k] ) << ( 8 * k );
+    }
+    return word;
+}
+
+void putValue( std::vector<unsigned char>& bytes, unsigned int value )
+{
+    while( value >= 0x80 ){
+        bytes.push_back( static_cast<unsigned char>( value | 0x80 ) );
+        value >>= 7;
+    }
+    bytes.push_back( static_cast<unsigned char>( value ) );
+}
+
+// Ids are coded as the zigzag difference to the previous id of the frame.
+void putId( std::vector<unsigned char>& bytes, unsigned int& lastId, unsigned int id )
+{
+    unsigned int delta = id - lastId;
+    putValue( bytes, ( delta << 1 ) ^ ( 0u - ( delta >> 31 ) ) );
+    lastId = id;
+}
+
+void putString( std::vector<unsigned char>& bytes, const std::string& text )
+{
+    putValue( bytes, static_cast<unsigned int>( text.size() ) );
+    bytes.insert( bytes.end(), text.begin(), text.end() );
+}
+
+class FrameReader
+{
+public:
+    FrameReader( const unsigned char* bytes, std::size_t size )
+        : bytes_( bytes ), size_( size )
+    {
+    }
+
+    bool done() const
+    {
+        return position_ >= size_;
+    }
+
+    unsigned int value()
+    {
+        unsigned int value = 0;
+        for( unsigned int shift = 0; shift < 35; shift += 7 ){
+            if( position_ >= size_ ){
+                throw std::runtime_error( "EditLog: frame ends inside a value" );
+            }
+            unsigned char byte = bytes_[position_++];
+            value |= static_cast<unsigned int>( byte & 0x7f ) << shift;
+            if( !( byte & 0x80 ) ){
+                return value;
+            }
+        }
+        throw std::runtime_error( "EditLog: bad value" );
+    }
+
+    unsigned int id()
+    {
+        unsigned int code = value();
+        lastId_ += ( code >> 1 ) ^ ( 0u - ( code & 1 ) );
+        return lastId_;
+    }
+
+    unsigned char output()
+    {
+        unsigned int output = value();
+        if( output >= doc::MaxGateOutputs ){
+            throw std::runtime_error( "EditLog: bad output" );
+        }
+        return static_cast<unsigned char>( output );
+    }
+
+    std::string text()
+    {
+        unsigned int size = value();
+        if( size > size_ - position_ ){
+            throw std::runtime_error( "EditLog: frame ends inside a string" );
+        }
+        std::string text( reinterpret_cast<const char*>( bytes_ + position_ ), size );
+        position_ += size;
+        return text;
+    }
+
+private:
+    const unsigned char* bytes_;
+    std::size_t size_;
+    std::size_t position_ = 0;
+    unsigned int lastId_ = 0;
+};
+
+// What an InstanceAdded change is replayed with. The module is a file
+// it was loaded from, or for one built in memory a copy of its body in
+// the session directory (`stored`).
+struct LoggedInstance
+{
+    std::string name;
+    std::string path;
+    bool stored = false;
+    std::vector<unsigned int> inputs;
+    std::vector<unsigned int> outputs;
+    std::vector<unsigned char> driverOutputs;
+};
+
+// Driver ids are coded one up, so Gate::NoGate takes a byte.
+void encodeInstance( std::vector<unsigned char>& bytes, unsigned int& lastId, unsigned int id, const LoggedInstance& instance )
+{
+    bytes.push_back( doc::Change::InstanceAdded );
+    putId( bytes, lastId, id );
+    putString( bytes, instance.name );
+    bytes.push_back( instance.stored );
+    putString( bytes, instance.path );
+    putValue( bytes, static_cast<unsigned int>( instance.inputs.size() ) );
+    for( unsigned int driverId : instance.inputs ){
+        putValue( bytes, driverId + 1 );
+    }
+    putValue( bytes, static_cast<unsigned int>( instance.outputs.size() ) );
+    for( unsigned int wireId : instance.outputs ){
+        putId( bytes, lastId, wireId );
+    }
+    putValue( bytes, static_cast<unsigned int>( instance.driverOutputs.size() ) );
+    bytes.insert( bytes.end(), instance.driverOutputs.begin(), instance.driverOutputs.end() );
+}
+
+// Appends one change; InstanceAdded goes through encodeInstance().
+void encode( std::vector<unsigned char>& bytes, unsigned int& lastId, const doc::Change& change )
+{
+    switch( change.kind ){
+    case doc::Change::GateAdded:
+        bytes.push_back( change.kind );
+        bytes.push_back( static_cast<unsigned char>( change.type ) );
+        putId( bytes, lastId, change.gate );
+        break;
+    case doc::Change::GateRemoved:
+        bytes.push_back( change.kind );
+        putId( bytes, lastId, change.gate );
+        break;
+    case doc::Change::EdgeAdded:
+    case doc::Change::EdgeRemoved:
+        bytes.push_back( change.kind );
+        bytes.push_back( change.port );
+        putId( bytes, lastId, change.gate );
+        putId( bytes, lastId, change.driver );
+        bytes.push_back( change.output );
+        break;
+    case doc::Change::TypeChanged:
+        bytes.push_back( change.kind );
+        bytes.push_back( static_cast<unsigned char>( change.type ) );
+        putId( bytes, lastId, change.gate );
+        break;
+    case doc::Change::InstanceRemoved:
+        bytes.push_back( change.kind );
+        putId( bytes, lastId, change.gate );
+        break;
+    case doc::Change::InstanceBound:
+        bytes.push_back( change.kind );
+        bytes.push_back( change.port );
+        putId( bytes, lastId, change.gate );
+        putValue( bytes, change.driver + 1 );
+        bytes.push_back( change.output );
+        break;
+    default:
+        break;
+    }
+}
+
+// A frame as read back: its changes, and for each InstanceAdded among
+// them, in order, the instance.
+struct Frame
+{
+    doc::ChangeBatch changes;
+    std::vector<LoggedInstance> instances;
+};
+
+Frame decode( const unsigned char* bytes, std::size_t size )
+{
+    Frame frame;
+    doc::ChangeBatch& changes = frame.changes;
+    FrameReader reader( bytes, size );
+    while( !reader.done() ){
+        doc::Change change{ static_cast<doc::Change::Kind>( reader.value() ), doc::GateType::INPUT, doc::GateType::INPUT, 0, doc::Gate::NoGate, doc::Gate::NoGate };
+        switch( change.kind ){
+        case doc::Change::GateAdded:
+        case doc::Change::TypeChanged:
+            change.type = static_cast<doc::GateType>( reader.value() );
+            change.gate = reader.id();
+            break;
+        case doc::Change::GateRemoved:
+            change.gate = reader.id();
+            break;
+        case doc::Change::EdgeAdded:
+        case doc::Change::EdgeRemoved:
+            change.port = static_cast<unsigned char>( reader.value() );
+            if( change.port >= doc::Gate::MaxInputs ){
+                throw std::runtime_error( "EditLog: bad port" );
+            }
+            change.gate = reader.id();
+            change.driver = reader.id();
+            change.output = reader.output();
+            break;
+        case doc::Change::InstanceAdded:{
+            change.gate = reader.id();
+            LoggedInstance instance;
+            instance.name = reader.text();
+            instance.stored = reader.value() != 0;
+            instance.path = reader.text();
+            instance.inputs.resize( reader.value() );
+            for( unsigned int& driverId : instance.inputs ){
+                driverId = reader.value() - 1;
+            }
+            instance.outputs.resize( reader.value() );
+            for( unsigned int& wireId : instance.outputs ){
+                wireId = reader.id();
+            }
+            instance.driverOutputs.resize( reader.value() );
+            for( unsigned char& output : instance.driverOutputs ){
+                output = reader.output();
+            }
+            frame.instances.push_back( std::move( instance ) );
+            break;
+        }
+        case doc::Change::InstanceRemoved:
+            change.gate = reader.id();
+            break;
+        case doc::Change::InstanceBound:
+            change.port = static_cast<unsigned char>( reader.value() );
+            change.gate = reader.id();
+            change.driver = reader.value() - 1;
+            change.output = reader.output();
+            break;
+        default:
+            throw std::runtime_error( "EditLog: unknown change" );
+        }
+        changes.push_back( change );
+    }
+    return frame;
+}
+
+// Modules a recovery meets, each file loaded once.
+class ModuleCache
+{
+public:
+    ModuleCache( std::string directory, const EditLog::Loader& loader )
+        : directory_( std::move( directory ) ), loader_( loader )
+    {
+    }
+
+    // A stored body is rebuilt as a module built in memory again, so a
+    // save holds it in full and the session file can go.
+    std::shared_ptr<const doc::Module> get( const LoggedInstance& instance )
+    {
+        std::string path = instance.stored ? ( fs::path( directory_ ) / instance.path ).string() : instance.path;
+        std::shared_ptr<const doc::Module>& module = modules_[path];
+        if( !module ){
+            module = std::make_shared<const doc::Module>( instance.name, loader_( path )->snapshot(),
+                                                          instance.stored ? std::string() : path );
+        }
+        return module;
+    }
+
+private:
+    std::string directory_;
+    const EditLog::Loader& loader_;
+    std::map<std::string, std::shared_ptr<const doc::Module>> modules_;
+};
+
+// A gate is added with the inputs it was added with, which the journal
+// reports as the edges right after it. An instance is logged after its
+// wires, which are replayed as plain gates first; it takes them over
+// with what they drive.
+void replay( doc::Document& doc, const Frame& frame, ModuleCache& modules )
+{
+    const doc::ChangeBatch& changes = frame.changes;
+    std::size_t instances = 0;
+    doc::ChangeJournal::Batch batch( doc.journal() );
+    for( std::size_t i = 0; i < changes.size(); ++i ){
+        const doc::Change& change = changes[i];
+        switch( change.kind ){
+        case doc::Change::GateAdded:{
+            doc::Gate::Inputs inputs;
+            doc::Gate::DriverOutputs outputs{};
+            inputs.fill( doc::Gate::NoGate );
+            for( std::size_t k = i + 1; k < changes.size() && changes[k].kind == doc::Change::EdgeAdded && changes[k].gate == change.gate; ++k ){
+                inputs[changes[k].port] = changes[k].driver;
+                outputs[changes[k].port] = changes[k].output;
+            }
+            doc.addGate( change.type, inputs, outputs, change.gate );
+            break;
+        }
+        case doc::Change::GateRemoved:
+            doc.removeaGate( change.gate );
+            break;
+        case doc::Change::EdgeAdded:
+            doc.connect( change.driver, change.port, change.gate, change.output );
+            break;
+        case doc::Change::EdgeRemoved:
+            if( doc.contains( change.gate ) && doc.driverOf( change.port, change.gate ) == change.driver
+                && doc.driverOutputOf( change.port, change.gate ) == change.output ){
+                doc.disconnect( change.port, change.gate );
+            }
+            break;
+        case doc::Change::TypeChanged:
+            doc.setType( change.gate, change.type );
+            break;
+        case doc::Change::InstanceAdded:{
+            const LoggedInstance& logged = frame.instances[instances++];
+            doc::Instance instance{ modules.get( logged ), logged.inputs, logged.outputs, logged.driverOutputs };
+            std::vector<doc::Net> fanout;
+            for( unsigned int wireId : logged.outputs ){
+                if( doc.contains( wireId ) ){
+                    fanout.push_back( doc.net( wireId ) );
+                    doc.removeaGate( wireId );
+                }
+            }
+            doc.addInstance( std::move( instance ), change.gate, fanout );
+            break;
+        }
+        case doc::Change::InstanceRemoved:
+            doc.removeInstance( change.gate );
+            break;
+        case doc::Change::InstanceBound:
+            if( doc.containsInstance( change.gate ) ){
+                bool driven = doc.contains( change.driver );
+                doc.bindInput( change.gate, change.port, driven ? change.driver : doc::Gate::NoGate, driven ? change.output : 0 );
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// Replays whole frames; false at a torn or corrupt one.
+bool replaySegment( doc::Document& doc, const std::string& path, ModuleCache& modules )
+{
+    std::FILE* file = std::fopen( path.c_str(), "rb" );
+    if( !file ){
+        return false;
+    }
+    std::vector<unsigned char> bytes;
+    unsigned char chunk[1 << 16];
+    std::size_t read;
+    while( ( read = std::fread( chunk, 1, sizeof( chunk ), file ) ) > 0 ){
+        bytes.insert( bytes.end(), chunk, chunk + read );
+    }
+    std::fclose( file );
+
+    if( bytes.size() < sizeof( Magic ) || std::memcmp( bytes.data(), Magic, sizeof( Magic ) ) != 0 ){
+        return false;
+    }
+    std::size_t position = sizeof( Magic );
+    while( position < bytes.size() ){
+        if( bytes.size() - position < FrameHeader ){
+            return false;
+        }
+        std::uint32_t size = getWord( &bytes[position] );
+        std::uint32_t sum = getWord( &bytes[position + 4] );
+        position += FrameHeader;
+        if( bytes.size() - position < size || checksum( &bytes[position], size ) != sum ){
+            return false;
+        }
+        replay( doc, decode( &bytes[position], size ), modules );
+        position += size;
+    }
+    return true;
+}
+
+struct SessionFiles
+{
+    // By number, ascending
+    std::vector<unsigned int> bases;
+    std::vector<unsigned int> segments;
+    std::vector<unsigned int> modules;
+};
+
+// Number of a "<prefix><n><suffix>" file name, or false.
+bool numberOf( const std::string& name, const std::string& prefix, const std::string& suffix, unsigned int& number )
+{
+    if( name.size() <= prefix.size() + suffix.size()
+        || name.compare( 0, prefix.size(), prefix ) != 0
+        || name.compare( name.size() - suffix.size(), suffix.size(), suffix ) != 0 ){
+        return false;
+    }
+    std::string digits = name.substr( prefix.size(), name.size() - prefix.size() - suffix.size() );
+    if( digits.find_first_not_of( "0123456789" ) != std::string::npos ){
+        return false;
+    }
+    number = static_cast<unsigned int>( std::stoul( digits ) );
+    return true;
+}
+
+SessionFiles listSession( const std::string& directory )
+{
+    SessionFiles files;
+    std::error_code error;
+    for( const fs::directory_entry& entry : fs::directory_iterator( directory, error ) ){
+        std::string name = entry.path().filename().string();
+        unsigned int number;
+        if( numberOf( name, "base.", ".json", number ) ){
+            files.bases.push_back( number );
+        }else if( numberOf( name, "edits.", ".log", number ) ){
+            files.segments.push_back( number );
+        }else if( numberOf( name, "module.", ".json", number ) ){
+            files.modules.push_back( number );
+        }
+    }
+    std::sort( files.bases.begin(), files.bases.end() );
+    std::sort( files.segments.begin(), files.segments.end() );
+    std::sort( files.modules.begin(), files.modules.end() );
+    return files;
+}
+
+std::string basePath( const std::string& directory, unsigned int number )
+{
+    return ( fs::path( directory ) / ( "base." + std::to_string( number ) + ".json" ) ).string();
+}
+
+std::string segmentPath( const std::string& directory, unsigned int number )
+{
+    return ( fs::path( directory ) / ( "edits." + std::to_string( number ) + ".log" ) ).string();
+}
+
+std::string modulePath( const std::string& directory, unsigned int number )
+{
+    return ( fs::path( directory ) / ( "module." + std::to_string( number ) + ".json" ) ).string();
+}
+
+// Deletes every file of the session numbered below `number`.
+void dropBefore( const std::string& directory, unsigned int number )
+{
+    SessionFiles files = listSession( directory );
+    std::error_code error;
+    for( unsigned int base : files.bases ){
+        if( base < number ){
+            fs::remove( basePath( directory, base ), error );
+        }
+    }
+    for( unsigned int segment : files.segments ){
+        if( segment < number ){
+            fs::remove( segmentPath( directory, segment ), error );
+        }
+    }
+}
+}
+
+
+
+EditLog::EditLog( std::string directory, doc::Document& doc, Saver saver, Stopped stopped )
+    : directory_( std::move( directory ) ), doc_( doc ), saver_( std::move( saver ) ), stopped_( std::move( stopped ) )
+{
+    SessionFiles files = listSession( directory_ );
+    if( !files.bases.empty() ){
+        segment_ = files.bases.back() + 1;
+    }
+    if( !files.segments.empty() ){
+        segment_ = std::max( segment_, files.segments.back() + 1 );
+    }
+    if( !files.modules.empty() ){
+        nextModule_ = files.modules.back() + 1;
+    }
+    // The document supersedes the files there: an empty one needs none,
+    // any other a base that recovery takes over them.
+    if( doc_.size() > 0 || doc_.instanceCaunt() > 0 ){
+        compact();
+        waitCompaction();
+    }else{
+        dropBefore( directory_, segment_ );
+        openSegment();
+    }
+    subscription_ = doc_.journal().subscribe( [this]( const doc::ChangeBatch& changes ){ append( changes ); } );
+}
+
+EditLog::~EditLog()
+{
+    doc_.journal().unsubscribe( subscription_ );
+    try{
+        flush();
+    }catch( const std::exception& error ){
+        std::cerr << error.what() << std::endl;
+    }
+    waitCompaction();
+    if( file_ ){
+        std::fclose( file_ );
+    }
+}
+
+// Runs inside the journal, so an error is handled here: logging stops,
+// `stopped` is told and flush() throws it from then on.
+void EditLog::append( const doc::ChangeBatch& changes )
+{
+    if( !error_.empty() ){
+        return;
+    }
+    try{
+        std::size_t start = buffer_.size();
+        buffer_.resize( start + FrameHeader );
+        unsigned int lastId = 0;
+        for( const doc::Change& change : changes ){
+            if( change.kind != doc::Change::InstanceAdded ){
+                encode( buffer_, lastId, change );
+                continue;
+            }
+            // The instance as the batch left it; one removed again in
+            // the same batch is skipped, its removal replays as nothing.
+            if( !doc_.containsInstance( change.gate ) ){
+                continue;
+            }
+            const doc::Instance& instance = doc_.instance( change.gate );
+            const std::shared_ptr<const doc::Module>& module = instance.module;
+            bool stored = module->path().empty();
+            encodeInstance( buffer_, lastId, change.gate,
+                            LoggedInstance{ module->name(), stored ? storedModule( module ) : module->path(), stored,
+                                            instance.inputs, instance.outputs, instance.driverOutputs } );
+        }
+        std::size_t size = buffer_.size() - start - FrameHeader;
+        if( size == 0 ){
+            buffer_.resize( start );
+            return;
+        }
+        putWord( buffer_, start, static_cast<std::uint32_t>( size ) );
+        putWord( buffer_, start + 4, checksum( &buffer_[start + FrameHeader], size ) );
+        if( buffer_.size() >= FlushBytes ){
+            flush();
+        }
+    }catch( const std::exception& error ){
+        error_ = error.what();
+        buffer_.clear();
+        doc_.journal().unsubscribe( subscription_ );
+        if( stopped_ ){
+            stopped_( error_ );
+        }else{
+            std::cerr << error_ << std::endl;
+        }
+    }
+}
+
+void EditLog::flush()
+{
+    if( !error_.empty() ){
+        throw std::runtime_error( error_ );
+    }
+    if( buffer_.empty() ){
+        return;
+    }
+    // The segment may end in a torn frame then; recovery stops there.
+    try{
+        if( std::fwrite( buffer_.data(), 1, buffer_.size(), file_ ) != buffer_.size() ){
+            throw std::runtime_error( "EditLog: write failed" );
+        }
+        syncFile( file_ );
+    }catch( const std::exception& error ){
+        error_ = error.what();
+        buffer_.clear();
+        throw;
+    }
+    logBytes_ += buffer_.size();
+    buffer_.clear();
+}
+
+void EditLog::compactIfLarge()
+{
+    if( logBytes_ + buffer_.size() < CompactBytes ){
+        return;
+    }
+    if( compaction_.valid() && compaction_.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready ){
+        return;
+    }
+    compact();
+}
+
+// The new segment starts where the snapshot is taken, so the base and
+// the segments from it on hold the whole document.
+void EditLog::compact()
+{
+    waitCompaction();
+    if( file_ ){
+        flush();
+        std::fclose( file_ );
+        file_ = nullptr;
+        ++segment_;
+    }
+    openSegment();
+    logBytes_ = 0;
+
+    std::shared_ptr<const doc::Netlist> snapshot = doc_.snapshot();
+    unsigned int gateCaunt = doc_.getGateCaunt();
+    unsigned int number = segment_;
+    std::string directory = directory_;
+    Saver saver = saver_;
+    compaction_ = std::async( std::launch::async, [=](){
+        std::string path = basePath( directory, number );
+        std::string temporary = path + ".tmp";
+        saver( temporary, *snapshot, gateCaunt );
+        syncPath( temporary );
+        fs::rename( temporary, path );
+        dropBefore( directory, number );
+    });
+}
+
+// Written once per module, before the first frame that refers to it.
+const std::string& EditLog::storedModule( const std::shared_ptr<const doc::Module>& module )
+{
+    std::string& name = storedModules_[module];
+    if( name.empty() ){
+        std::string path = modulePath( directory_, nextModule_ );
+        saver_( path, module->body(), module->body().size() );
+        syncPath( path );
+        ++nextModule_;
+        name = fs::path( path ).filename().string();
+    }
+    return name;
+}
+
+std::size_t EditLog::logBytes() const
+{
+    return logBytes_ + buffer_.size();
+}
+
+void EditLog::openSegment()
+{
+    std::string path = segmentPath( directory_, segment_ );
+    file_ = std::fopen( path.c_str(), "wb" );
+    if( !file_ ){
+        throw std::runtime_error( "EditLog: cannot open " + path );
+    }
+    if( std::fwrite( Magic, 1, sizeof( Magic ), file_ ) != sizeof( Magic ) ){
+        throw std::runtime_error( "EditLog: write failed" );
+    }
+    syncFile( file_ );
+}
+
+// A failed compaction keeps the older files; the next one tries again.
+void EditLog::waitCompaction()
+{
+    if( !compaction_.valid() ){
+        return;
+    }
+    try{
+        compaction_.get();
+    }catch( const std::exception& error ){
+        std::cerr << "EditLog: compaction: " << error.what() << std::endl;
+    }
+}
+
+std::shared_ptr<doc::Document> EditLog::recover( const std::string& directory, const Loader& loader )
+{
+    SessionFiles files = listSession( directory );
+    if( files.bases.empty() && files.segments.empty() ){
+        return nullptr;
+    }
+    unsigned int first = 0;
+    std::shared_ptr<doc::Document> doc;
+    if( !files.bases.empty() ){
+        first = files.bases.back();
+        doc = loader( basePath( directory, first ) );
+    }else{
+        doc = std::make_shared<doc::Document>();
+    }
+    ModuleCache modules( directory, loader );
+    for( unsigned int segment : files.segments ){
+        if( segment >= first && !replaySegment( *doc, segmentPath( directory, segment ), modules ) ){
+            break;
+        }
+    }
+    return doc;
+}
+
+void EditLog::discard( const std::string& directory )
+{
+    dropBefore( directory, ~0u );
+    std::error_code error;
+    for( unsigned int module : listSession( directory ).modules ){
+        fs::remove( modulePath( directory, module ), error );
+    }
+}
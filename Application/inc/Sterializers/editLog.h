@@ -0,0 +1,93 @@
+#pragma once
+
+
+#include "../Document/document.h"
+#include "../Document/module.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////////////////
+///Edit log
+///Write-ahead log of a document for autosave and crash recovery. Every
+///batch the document journal publishes is appended to the current
+///segment as one checksummed frame of a few bytes per change, and
+///frames are synced to disk in small groups, so an autosave costs what
+///the edit costs. Once the segments outgrow CompactBytes a snapshot is
+///saved as a new base on a background thread; the segments it covers
+///are deleted after. Files in the directory:
+///  base.<n>.json   full save holding every segment before n
+///  edits.<n>.log   frames logged from segment n on
+///  module.<n>.json body of a module built in memory that a logged
+///                  instance uses; kept until discard()
+///An instance is logged with its port binding, its wires and the file
+///its module comes from.
+//////////////////////////////////////////////////////////////
+class EditLog
+{
+public:
+    using Loader = std::function<std::shared_ptr<doc::Document>( const std::string& path )>;
+    using Saver = std::function<void( const std::string& path, const doc::Netlist& netlist, unsigned int gateCaunt )>;
+    using Stopped = std::function<void( const std::string& error )>;
+
+    static constexpr std::size_t FlushBytes = 64 * 1024;
+    static constexpr std::size_t CompactBytes = 4 * 1024 * 1024;
+
+public:
+    // Logs `doc` into `directory`, which must exist, from now on. Files
+    // of an earlier session there are superseded, so recover() first; a
+    // document that is not empty is saved as a base before this returns.
+    // `stopped` hears of a write that fails while the journal publishes;
+    // the log is unsubscribed by then. Without it the error is printed.
+    EditLog( std::string directory, doc::Document& doc, Saver saver, Stopped stopped = nullptr );
+    ~EditLog();
+    EditLog( const EditLog& ) = delete;
+    EditLog& operator=( const EditLog& ) = delete;
+
+    // Syncs the frames appended since the last flush. Throws the error
+    // that stopped logging, also one met while the journal published.
+    void flush();
+    // Starts a background compaction if the segments are large and none runs.
+    void compactIfLarge();
+    // Saves a new base now; waits for a compaction that still runs.
+    void compact();
+
+    // Bytes logged since the last base.
+    std::size_t logBytes() const;
+
+    // The document the last session in `directory` left: its newest
+    // base with the segments after it replayed up to the first torn
+    // frame. Null if there is no session there.
+    static std::shared_ptr<doc::Document> recover( const std::string& directory, const Loader& loader );
+    // Deletes the session files, e.g. on a clean exit.
+    static void discard( const std::string& directory );
+
+private:
+    void append( const doc::ChangeBatch& changes );
+    const std::string& storedModule( const std::shared_ptr<const doc::Module>& module );
+    void openSegment();
+    void waitCompaction();
+
+private:
+    std::string directory_;
+    doc::Document& doc_;
+    Saver saver_;
+    Stopped stopped_;
+    unsigned int subscription_;
+    unsigned int segment_ = 0;
+    std::FILE* file_ = nullptr;
+    std::vector<unsigned char> buffer_;
+    std::size_t logBytes_ = 0;
+    std::future<void> compaction_;
+    // Set once a write fails; nothing is logged after it.
+    std::string error_;
+    // File name of each module stored in the directory.
+    std::map<std::shared_ptr<const doc::Module>, std::string> storedModules_;
+    unsigned int nextModule_ = 0;
+};
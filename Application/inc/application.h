@@ -1,18 +1,35 @@
 #pragma once
 #include <QApplication>
+#include <QLockFile>
+#include <QTimer>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include "./Document/document.h"
+#include "./Document/fingerprint.h"
+#include "./Document/module.h"
+#include "./Editor/editor.h"
+#include "./Sterializers/editLog.h"
 #include "./GUI/Components/graphicItem.h"
 
 class MyApplication : public QApplication
 {
 Q_OBJECT
 public:
+    // Memory the undo history of a document may take
+    static constexpr std::size_t HistoryBudget = 256u * 1024 * 1024;
+    // A design file bigger than this is opened into a mapped arena
+    static constexpr qint64 LargeDesignBytes = 512ll * 1024 * 1024;
+
     explicit MyApplication(int &argc, char **argv);
+    // A clean exit leaves no session to recover
+    ~MyApplication();
 
     static MyApplication* instance();
 
     std::shared_ptr<doc::Document> getDocument();
+    // Undo history of the current document
+    edt::Editor& getEditor();
 
     bool notify(QObject *receiver, QEvent *event) override;
     const QBrush &backgroundBrush() const;
@@ -23,17 +40,43 @@ public slots:
     void newDocument(const QString&);
     void addProjectJsonFile( const QString& path );
     void editorControl( const QString& actionName );
-    void addGateInDoc( const QString& gateType );
+    // History slider: 0 is the oldest kept state, undo plus redo caunt the newest
+    void historyJump( int position );
+    unsigned int addGateInDoc( const QString& gateType );
     void lineAndGraphicSchenBridg( const QPointF &sourcePoint, const QPointF &targetPoint );
     void addConnect( gui::AGraphicsItem* ithemC, gui::AGraphicsItem* ithemI );
     
 signals:
     void SignaLLineAndGraphicSchenBridg( const QPointF &sourcePoint, const QPointF &targetPoint );
+    // One batch of document changes, published by the document journal
+    void documentChanged( const doc::ChangeBatch& changes );
  
 private:
     void initBackgroundPattern();
+    void attachDocument( std::shared_ptr<doc::Document> doc );
+    // Picks the autosave session of this instance; returns the document
+    // of a crashed one it takes over, if any
+    std::shared_ptr<doc::Document> openAutosaveSession();
+    void autosave();
+    // Scratch-file arena for a design that may not fit in memory; null
+    // where files cannot be mapped
+    std::shared_ptr<doc::Arena> largeDesignArena();
 private:
     std::shared_ptr<doc::Document> doc_;
+    unsigned int journalHandle_ = 0;
+    std::unique_ptr<edt::Editor> editor_;
+    // Follows doc_; a save is skipped while the design is the one last saved there
+    std::unique_ptr<doc::Fingerprint> fingerprint_;
+    std::string savedPath_;
+    std::uint64_t savedFingerprint_ = 0;
+    // Loaded project definitions by path; every instance shares one
+    std::unordered_map<std::string, std::shared_ptr<const doc::Module>> modules_;
+    // Write-ahead log of doc_ for crash recovery, synced by the timer.
+    // The directory is this instance's alone while it holds the lock
+    std::string autosaveDir_;
+    std::unique_ptr<QLockFile> autosaveLock_;
+    std::unique_ptr<EditLog> editLog_;
+    QTimer autosaveTimer_;
     QBrush m_backgroundBrush;
     
 };
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "../../inc/Document/arena.h"
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define DOC_ARENA_MMAP 1
+#endif
+
+namespace doc
+{
+
+
+Arena::~Arena()
+{
+#ifdef DOC_ARENA_MMAP
+    if(file_ != -1)
+    {
+        for(char* segment : segments_)
+        {
+            munmap(segment, SegmentBytes);
+        }
+        close(file_);
+        return;
+    }
+#endif
+    for(void* slab : slabs_)
+    {
+        ::operator delete(slab);
+    }
+}
+
+std::shared_ptr<Arena> Arena::mapped(const std::string &path)
+{
+#ifdef DOC_ARENA_MMAP
+    std::shared_ptr<Arena> arena = std::make_shared<Arena>();
+    arena->file_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if(arena->file_ == -1)
+    {
+        throw std::runtime_error("Arena: cannot create " + path);
+    }
+    unlink(path.c_str());
+    return arena;
+#else
+    throw std::runtime_error("Arena: memory-mapped files are not supported here (" + path + ")");
+#endif
+}
+
+unsigned int Arena::slabCaunt() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slabs_.size();
+}
+
+bool Arena::isMapped() const
+{
+    return file_ != -1;
+}
+
+void Arena::flush()
+{
+#ifdef DOC_ARENA_MMAP
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(char* segment : segments_)
+    {
+        msync(segment, SegmentBytes, MS_ASYNC);
+    }
+#endif
+}
+
+void Arena::adviseSequential()
+{
+#ifdef DOC_ARENA_MMAP
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(char* segment : segments_)
+    {
+        madvise(segment, SegmentBytes, MADV_SEQUENTIAL);
+    }
+#endif
+}
+
+void *Arena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    std::size_t size = blockSize(bytes);
+    if(size > MaxBlockBytes || alignment > alignof(std::max_align_t))
+    {
+        return ::operator new(bytes, std::align_val_t(alignment));
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Pool& free = pool(size);
+    if(free.free == nullptr)
+    {
+        char* slab = newSlab();
+        // Thread the new blocks onto the free list, lowest address first.
+        for(std::size_t offset = SlabBytes / size * size; offset != 0; offset -= size)
+        {
+            void* block = slab + offset - size;
+            *static_cast<void**>(block) = free.free;
+            free.free = block;
+        }
+    }
+    void* block = free.free;
+    free.free = *static_cast<void**>(block);
+    return block;
+}
+
+void Arena::do_deallocate(void *block, std::size_t bytes, std::size_t alignment)
+{
+    std::size_t size = blockSize(bytes);
+    if(size > MaxBlockBytes || alignment > alignof(std::max_align_t))
+    {
+        ::operator delete(block, std::align_val_t(alignment));
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Pool& free = pool(size);
+    *static_cast<void**>(block) = free.free;
+    free.free = block;
+}
+
+bool Arena::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this == &other;
+}
+
+// Rounds up so every block can hold the free-list link and stays aligned.
+std::size_t Arena::blockSize(std::size_t bytes)
+{
+    constexpr std::size_t align = alignof(std::max_align_t);
+    return (std::max<std::size_t>(bytes, sizeof(void*)) + align - 1) / align * align;
+}
+
+Arena::Pool &Arena::pool(std::size_t size)
+{
+    for(Pool& pool : pools_)
+    {
+        if(pool.blockSize == size)
+        {
+            return pool;
+        }
+    }
+    pools_.push_back(Pool{ size, nullptr });
+    return pools_.back();
+}
+
+// Caller holds the lock. A mapped arena grows its file by one segment
+// at a time and maps it whole; the slabs are cut from it in order.
+char *Arena::newSlab()
+{
+    char* slab = nullptr;
+#ifdef DOC_ARENA_MMAP
+    if(file_ != -1)
+    {
+        if(segmentUsed_ == SegmentBytes)
+        {
+            off_t offset = static_cast<off_t>(segments_.size()) * SegmentBytes;
+            if(ftruncate(file_, offset + SegmentBytes) != 0)
+            {
+                throw std::bad_alloc();
+            }
+            void* segment = mmap(nullptr, SegmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, file_, offset);
+            if(segment == MAP_FAILED)
+            {
+                throw std::bad_alloc();
+            }
+            segments_.push_back(static_cast<char*>(segment));
+            segmentUsed_ = 0;
+        }
+        slab = segments_.back() + segmentUsed_;
+        segmentUsed_ += SlabBytes;
+    }
+#endif
+    if(slab == nullptr)
+    {
+        slab = static_cast<char*>(::operator new(SlabBytes));
+    }
+    slabs_.push_back(slab);
+    return slab;
+}
+
+} // namespace doc
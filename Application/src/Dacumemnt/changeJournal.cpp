@@ -0,0 +1,130 @@
+#include "../../inc/Document/changeJournal.h"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <iterator>
+
+namespace doc
+{
+
+
+ChangeJournal::Batch::Batch(ChangeJournal &journal)
+    : journal_(journal)
+{
+    journal_.beginBatch();
+}
+
+ChangeJournal::Batch::~Batch()
+{
+    journal_.endBatch();
+}
+
+unsigned int ChangeJournal::subscribe(Subscriber subscriber)
+{
+    unsigned int handle = nextHandle_++;
+    (publishing_ ? added_ : subscribers_).emplace_back(handle, std::move(subscriber));
+    return handle;
+}
+
+// While a batch is delivered the subscriber is only emptied, so the
+// ones after it keep their place; publish() erases it after.
+void ChangeJournal::unsubscribe(unsigned int handle)
+{
+    auto matches = [handle](const std::pair<unsigned int, Subscriber>& s) { return s.first == handle; };
+    added_.erase(std::remove_if(added_.begin(), added_.end(), matches), added_.end());
+    if(publishing_)
+    {
+        auto it = std::find_if(subscribers_.begin(), subscribers_.end(), matches);
+        if(it != subscribers_.end())
+        {
+            it->second = nullptr;
+        }
+        return;
+    }
+    subscribers_.erase(std::remove_if(subscribers_.begin(), subscribers_.end(), matches), subscribers_.end());
+}
+
+void ChangeJournal::record(const Change &change)
+{
+    if(subscribers_.empty())
+    {
+        return;
+    }
+    pending_.push_back(change);
+    if(depth_ == 0)
+    {
+        publish();
+    }
+}
+
+void ChangeJournal::beginBatch()
+{
+    ++depth_;
+}
+
+void ChangeJournal::endBatch()
+{
+    if(depth_ > 0 && --depth_ == 0)
+    {
+        publish();
+    }
+}
+
+bool ChangeJournal::inBatch() const
+{
+    return depth_ != 0;
+}
+
+// Edits made by a subscriber while a batch is delivered are queued and
+// published as the next batch once every subscriber has seen this one.
+// Batches mostly end in Batch::~Batch, where an exception cannot get
+// out; one that a subscriber failed to handle is logged there instead.
+void ChangeJournal::publish()
+{
+    if(publishing_)
+    {
+        return;
+    }
+    publishing_ = true;
+    while(!pending_.empty())
+    {
+        ChangeBatch batch;
+        batch.swap(pending_);
+        for(std::size_t k = 0; k < subscribers_.size(); ++k)
+        {
+            if(!subscribers_[k].second)
+            {
+                continue;
+            }
+            try
+            {
+                subscribers_[k].second(batch);
+            }
+            catch(const std::exception& error)
+            {
+                std::cerr << "ChangeJournal: subscriber failed: " << error.what() << std::endl;
+            }
+            catch(...)
+            {
+                settleSubscribers();
+                publishing_ = false;
+                throw;
+            }
+        }
+        settleSubscribers();
+    }
+    publishing_ = false;
+}
+
+// Applies what subscribe() and unsubscribe() left for after a batch.
+void ChangeJournal::settleSubscribers()
+{
+    subscribers_.erase(std::remove_if(subscribers_.begin(), subscribers_.end(),
+                                      [](const std::pair<unsigned int, Subscriber>& s) { return !s.second; }),
+                       subscribers_.end());
+    std::move(added_.begin(), added_.end(), std::back_inserter(subscribers_));
+    added_.clear();
+}
+
+} // namespace doc
@@ -1,37 +1,460 @@
 #include "../../inc/Document/document.h"
+#include "../../inc/Document/module.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 
 namespace doc {
 
-    
-void Document::addGate(const Gate &gate)
+namespace
+{
+void addSinks(const Netlist& netlist, unsigned int id, std::vector<unsigned int>& ids)
 {
-    this->gateMap.emplace(gate.getId(), gate);
+    const NetlistStore& store = netlist.store();
+    unsigned int index = netlist.indexOf(id);
+    for(unsigned int k = 0; k < store.fanoutCaunt(index); ++k)
+    {
+        ids.push_back(store.id(store.fanoutAt(index, k)));
+    }
+}
+}
+
+//////////////////////////////////////////////////////////////
+///Document
+//////////////////////////////////////////////////////////////
+Document::Document(std::shared_ptr<Arena> arena)
+    : Netlist(std::move(arena))
+{
+}
+
+unsigned int Document::addGate(const Gate &gate)
+{
+    return addGate(gate.getType(), gate.getInputs(), gate.getDriverOutputs(), gate.getId());
+}
+
+unsigned int Document::addGate(GateType type, const Gate::Inputs &inputs, const Gate::DriverOutputs &outputs,
+                               unsigned int id, const std::vector<Net> &fanout)
+{
+    bool outputsFit = std::all_of(outputs.begin(), outputs.end(), [](unsigned int output) { return output < MaxGateOutputs; })
+                      && std::all_of(fanout.begin(), fanout.end(), [](const Net& net) { return net.output < MaxGateOutputs; });
+    if(!outputsFit)
+    {
+        throw std::out_of_range("Document: gate output out of range");
+    }
+    if(id == Gate::NoGate)
+    {
+        id = slots_.allocate();
+    }
+    else if(!slots_.allocateAt(id))
+    {
+        throw std::invalid_argument("Document: gate id " + std::to_string(id) + " is in use");
+    }
+
+    // New gates go to the end of the store; once dead entries outnumber
+    // live ones the store is packed again.
+    unsigned int dead = store_.size() - store_.liveCaunt();
+    if(dead > 1024 && dead > store_.liveCaunt())
+    {
+        reorder(topo_.order());
+    }
+
+    ChangeJournal::Batch batch(journal_);
+    unsigned int pinCaunt = descriptor(type).inputCaunt;
+    for(unsigned int port = pinCaunt; port < Gate::MaxInputs; ++port)
+    {
+        if(inputs[port] != Gate::NoGate)
+        {
+            pinCaunt = port + 1;
+        }
+    }
+    unsigned int index = store_.addGate(id, type, pinCaunt);
+    setPosition(id, index);
+    topo_.addNode(index);
+    journal_.record(Change{ Change::GateAdded, type, type, 0, id, Gate::NoGate });
+
+    // Taken out before any edge goes in: the table may rehash while the
+    // inputs are reconnected or rolled back.
+    std::vector<PendingInput> waiting;
+    auto range = pending_.equal_range(id);
+    for(auto it = range.first; it != range.second; ++it)
+    {
+        waiting.push_back(it->second);
+    }
+    pending_.erase(range.first, range.second);
+    try
+    {
+        for(unsigned int port = 0; port < pinCaunt; ++port)
+        {
+            unsigned int driverId = inputs[port];
+            if(driverId == Gate::NoGate)
+            {
+                continue;
+            }
+            if(contains(driverId))
+            {
+                addEdge(indexOf(driverId), port, index, outputs[port]);
+            }
+            else
+            {
+                pending_.emplace(driverId, PendingInput{ id, port, outputs[port] });
+            }
+        }
+        for(const PendingInput& input : waiting)
+        {
+            if(contains(input.sinkId) && store_.fanin(indexOf(input.sinkId), input.port) == NetlistStore::npos)
+            {
+                addEdge(index, input.port, indexOf(input.sinkId), input.output);
+            }
+        }
+        for(const Net& net : fanout)
+        {
+            for(const Pin& sink : net.sinks)
+            {
+                if(contains(sink.gateId) && store_.fanin(indexOf(sink.gateId), sink.port) == NetlistStore::npos)
+                {
+                    addEdge(index, sink.port, indexOf(sink.gateId), net.output);
+                }
+            }
+        }
+    }
+    catch(const CycleError&)
+    {
+        // removeaGate drops the inputs the gate parked; sinks that
+        // waited for its id keep waiting.
+        removeaGate(id);
+        for(const PendingInput& input : waiting)
+        {
+            pending_.emplace(id, input);
+        }
+        throw;
+    }
+    return id;
 }
 
+// The edges of the gate are reported as removed before the gate itself.
 void Document::removeaGate(unsigned int id)
 {
-    gateMap.erase(id);
+    if(!contains(id))
+    {
+        return;
+    }
+    ChangeJournal::Batch batch(journal_);
+    unsigned int index = indexOf(id);
+    for(unsigned int port = 0; port < store_.faninCaunt(index); ++port)
+    {
+        unsigned int driver = store_.fanin(index, port);
+        if(driver != NetlistStore::npos)
+        {
+            recordEdge(Change::EdgeRemoved, driver, port, index, store_.faninOutput(index, port));
+        }
+    }
+    // A self loop was already reported with the fanin.
+    for(unsigned int k = 0; k < store_.fanoutCaunt(index); ++k)
+    {
+        if(store_.fanoutAt(index, k) != index)
+        {
+            recordEdge(Change::EdgeRemoved, index, store_.fanoutPort(index, k), store_.fanoutAt(index, k),
+                       store_.fanoutOutput(index, k));
+        }
+    }
+    // Its inputs stop waiting too, or a gate that gets the id again once
+    // the slot generation wraps would be wired in their place.
+    for(auto it = pending_.begin(); it != pending_.end(); )
+    {
+        it = it->second.sinkId == id ? pending_.erase(it) : std::next(it);
+    }
+    GateType type = store_.type(index);
+    store_.removeGate(index);
+    topo_.removeNode(index);
+    slots_.release(id);
+    journal_.record(Change{ Change::GateRemoved, type, type, 0, id, Gate::NoGate });
+}
+
+void Document::connect(unsigned int driverId, unsigned int port, unsigned int sinkId, unsigned int output)
+{
+    if(port >= MaxGateInputs)
+    {
+        throw std::out_of_range("Document: gate port out of range");
+    }
+    if(output >= MaxGateOutputs)
+    {
+        throw std::out_of_range("Document: gate output out of range");
+    }
+    unsigned int sink = indexOf(sinkId);
+    unsigned int driver = indexOf(driverId);
+    unsigned int previous = store_.fanin(sink, port);
+    unsigned int previousOutput = store_.faninOutput(sink, port);
+    if(previous == driver && previousOutput == output)
+    {
+        return;
+    }
+    topo_.insertEdge(store_, driver, sink);
+    ChangeJournal::Batch batch(journal_);
+    if(previous != NetlistStore::npos)
+    {
+        recordEdge(Change::EdgeRemoved, previous, port, sink, previousOutput);
+    }
+    store_.setFanin(sink, port, driver, output);
+    recordEdge(Change::EdgeAdded, driver, port, sink, output);
+}
+
+void Document::disconnect(unsigned int port, unsigned int sinkId)
+{
+    unsigned int sink = indexOf(sinkId);
+    unsigned int driver = store_.fanin(sink, port);
+    if(driver == NetlistStore::npos)
+    {
+        return;
+    }
+    unsigned int output = store_.faninOutput(sink, port);
+    store_.clearFanin(sink, port);
+    recordEdge(Change::EdgeRemoved, driver, port, sink, output);
+}
+
+void Document::setType(unsigned int id, GateType type)
+{
+    unsigned int index = indexOf(id);
+    GateType oldType = store_.type(index);
+    if(oldType == type)
+    {
+        return;
+    }
+    store_.setType(index, type);
+    journal_.record(Change{ Change::TypeChanged, type, oldType, 0, id, Gate::NoGate });
+}
+
+unsigned int Document::addInstance(Instance instance, unsigned int id, const std::vector<Net> &fanout)
+{
+    if(!instance.module)
+    {
+        throw std::invalid_argument("Document: instance without a module");
+    }
+    if(id == Gate::NoGate)
+    {
+        id = instanceSlots_.allocate();
+    }
+    else if(!instanceSlots_.allocateAt(id))
+    {
+        throw std::invalid_argument("Document: instance id " + std::to_string(id) + " is in use");
+    }
+
+    ChangeJournal::Batch batch(journal_);
+    instance.inputs.resize(instance.module->inputCaunt(), Gate::NoGate);
+    instance.outputs.resize(instance.module->outputCaunt(), Gate::NoGate);
+    instance.driverOutputs.resize(instance.inputs.size(), 0);
+    Gate::Inputs open;
+    open.fill(Gate::NoGate);
+    for(unsigned int& wireId : instance.outputs)
+    {
+        std::vector<Net> wireFanout;
+        std::copy_if(fanout.begin(), fanout.end(), std::back_inserter(wireFanout),
+                     [&](const Net& net) { return net.driver == wireId; });
+        wireId = addGate(GateType::INPUT, open, Gate::DriverOutputs{}, wireId, wireFanout);
+    }
+    unsigned int index = SlotMap::indexOf(id);
+    if(index >= instances_.size())
+    {
+        instances_.resize(index + 1);
+    }
+    instances_.set(index, instance);
+    journal_.record(Change{ Change::InstanceAdded, GateType::INPUT, GateType::INPUT, 0, id, Gate::NoGate });
+    return id;
+}
+
+void Document::removeInstance(unsigned int id)
+{
+    if(!containsInstance(id))
+    {
+        return;
+    }
+    ChangeJournal::Batch batch(journal_);
+    unsigned int index = SlotMap::indexOf(id);
+    std::vector<unsigned int> wires = instances_[index].outputs;
+    for(unsigned int wireId : wires)
+    {
+        removeaGate(wireId);
+    }
+    instances_.set(index, Instance());
+    instanceSlots_.release(id);
+    journal_.record(Change{ Change::InstanceRemoved, GateType::INPUT, GateType::INPUT, 0, id, Gate::NoGate });
+}
+
+void Document::bindInput(unsigned int instanceId, unsigned int port, unsigned int driverId, unsigned int output)
+{
+    if(port >= instance(instanceId).inputs.size())
+    {
+        throw std::out_of_range("Document: instance port out of range");
+    }
+    if(driverId != Gate::NoGate && !contains(driverId))
+    {
+        throw std::out_of_range("Document: no gate with id " + std::to_string(driverId));
+    }
+    if(output >= MaxGateOutputs)
+    {
+        throw std::out_of_range("Document: gate output out of range");
+    }
+    output = driverId == Gate::NoGate ? 0 : output;
+    Instance& bound = instances_.mut(SlotMap::indexOf(instanceId));
+    bound.inputs[port] = driverId;
+    bound.driverOutputs.resize(bound.inputs.size(), 0);
+    bound.driverOutputs[port] = static_cast<unsigned char>(output);
+    journal_.record(Change{ Change::InstanceBound, GateType::INPUT, GateType::INPUT,
+                            static_cast<unsigned char>(port), instanceId, driverId, static_cast<unsigned char>(output) });
+}
+
+void Document::renumber(GateOrder order)
+{
+    switch(order)
+    {
+    case GateOrder::DepthFirst:
+        reorder(depthFirstOrder(store_));
+        break;
+    case GateOrder::Topological:
+        reorder(topo_.order());
+        break;
+    case GateOrder::CuthillMcKee:
+        reorder(cuthillMcKeeOrder(store_));
+        break;
+    }
+}
+
+std::shared_ptr<const Netlist> Document::snapshot() const
+{
+    return std::make_shared<const Netlist>(static_cast<const Netlist&>(*this));
 }
 
-Document::iterator Document::begin()
+std::size_t Document::Checkpoint::bytesApartFrom(const Netlist &newer) const
 {
-    return gateMap.begin();
+    return netlist->bytesApartFrom(newer) + pending.capacity() * sizeof(pending.front());
 }
 
-Document::iterator Document::end()
+Document::Checkpoint Document::checkpoint() const
 {
-    return gateMap.end();
+    Checkpoint checkpoint{ snapshot(), {} };
+    checkpoint.pending.assign(pending_.begin(), pending_.end());
+    return checkpoint;
 }
 
-Document::iterator Document::find(unsigned int id)
+// Gates are compared by id. Edges belong to their sink, so a gate that
+// comes or goes brings in the sinks it drives on the side it is on; the
+// sinks of a gate on both sides differ only by edits of their own. Changes
+// are recorded in the order edits record them: edges that go, gates
+// that go or change type, gates that come, edges that come.
+void Document::restore(const Checkpoint &checkpoint, std::vector<unsigned int> touched)
 {
-    return gateMap.find(id);
+    const Netlist& target = *checkpoint.netlist;
+    std::size_t caunt = touched.size();
+    for(std::size_t k = 0; k < caunt; ++k)
+    {
+        bool before = contains(touched[k]);
+        if(before != target.contains(touched[k]))
+        {
+            addSinks(before ? *this : target, touched[k], touched);
+        }
+    }
+    // Duplicates go by slot; ids sharing a slot across the two sides are
+    // few and sorted out apart.
+    std::vector<unsigned int> seen;
+    std::vector<unsigned int> shared;
+    std::size_t kept = 0;
+    for(unsigned int id : touched)
+    {
+        unsigned int slot = SlotMap::indexOf(id);
+        if(slot >= seen.size())
+        {
+            seen.resize(std::max<std::size_t>(slot + 1, seen.size() * 2), Gate::NoGate);
+        }
+        if(seen[slot] == Gate::NoGate)
+        {
+            seen[slot] = id;
+            touched[kept++] = id;
+        }
+        else if(seen[slot] != id)
+        {
+            shared.push_back(id);
+        }
+    }
+    touched.resize(kept);
+    std::sort(shared.begin(), shared.end());
+    shared.erase(std::unique(shared.begin(), shared.end()), shared.end());
+    touched.insert(touched.end(), shared.begin(), shared.end());
+
+    const NetlistStore& oldStore = store_;
+    const NetlistStore& newStore = target.store();
+    std::vector<Change> edgesRemoved;
+    std::vector<Change> gatesRemoved;
+    std::vector<Change> gatesAdded;
+    std::vector<Change> edgesAdded;
+    for(unsigned int id : touched)
+    {
+        bool before = contains(id);
+        bool after = target.contains(id);
+        if(!before && !after)
+        {
+            continue;
+        }
+        unsigned int oldIndex = before ? indexOf(id) : NetlistStore::npos;
+        unsigned int newIndex = after ? target.indexOf(id) : NetlistStore::npos;
+        GateType oldType = before ? oldStore.type(oldIndex) : GateType::INPUT;
+        GateType newType = after ? newStore.type(newIndex) : GateType::INPUT;
+        unsigned int oldCaunt = before ? oldStore.faninCaunt(oldIndex) : 0;
+        unsigned int newCaunt = after ? newStore.faninCaunt(newIndex) : 0;
+        for(unsigned int port = 0; port < std::max(oldCaunt, newCaunt); ++port)
+        {
+            unsigned int oldDriver = port < oldCaunt ? oldStore.fanin(oldIndex, port) : NetlistStore::npos;
+            unsigned int newDriver = port < newCaunt ? newStore.fanin(newIndex, port) : NetlistStore::npos;
+            unsigned char oldOutput = port < oldCaunt ? oldStore.faninOutput(oldIndex, port) : 0;
+            unsigned char newOutput = port < newCaunt ? newStore.faninOutput(newIndex, port) : 0;
+            oldDriver = oldDriver == NetlistStore::npos ? Gate::NoGate : oldStore.id(oldDriver);
+            newDriver = newDriver == NetlistStore::npos ? Gate::NoGate : newStore.id(newDriver);
+            if(oldDriver == newDriver && oldOutput == newOutput)
+            {
+                continue;
+            }
+            if(oldDriver != Gate::NoGate)
+            {
+                edgesRemoved.push_back(Change{ Change::EdgeRemoved, oldType, oldType, static_cast<unsigned char>(port), id, oldDriver, oldOutput });
+            }
+            if(newDriver != Gate::NoGate)
+            {
+                edgesAdded.push_back(Change{ Change::EdgeAdded, newType, newType, static_cast<unsigned char>(port), id, newDriver, newOutput });
+            }
+        }
+        if(!after)
+        {
+            gatesRemoved.push_back(Change{ Change::GateRemoved, oldType, oldType, 0, id, Gate::NoGate });
+        }
+        else if(!before)
+        {
+            gatesAdded.push_back(Change{ Change::GateAdded, newType, newType, 0, id, Gate::NoGate });
+        }
+        else if(oldType != newType)
+        {
+            gatesRemoved.push_back(Change{ Change::TypeChanged, newType, oldType, 0, id, Gate::NoGate });
+        }
+    }
+
+    static_cast<Netlist&>(*this) = target;
+    pending_.clear();
+    pending_.insert(checkpoint.pending.begin(), checkpoint.pending.end());
+
+    ChangeJournal::Batch batch(journal_);
+    for(const std::vector<Change>* changes : { &edgesRemoved, &gatesRemoved, &gatesAdded, &edgesAdded })
+    {
+        for(const Change& change : *changes)
+        {
+            journal_.record(change);
+        }
+    }
 }
 
-Gate &Document::at(unsigned int id)
+ChangeJournal &Document::journal()
 {
-    gateMap.at(id);
+    return journal_;
 }
 
 unsigned int Document::getGateCaunt()
@@ -43,5 +466,36 @@ void Document::setgateCaunt(unsigned int caunt)
     GateCaunt = caunt;
 }
 
+// Checks the order first, so a rejected edge leaves the store untouched.
+// `order` lists every live gate by store index.
+void Document::reorder(const std::vector<unsigned int> &order)
+{
+    std::vector<unsigned int> topo = topo_.order();
+    std::vector<unsigned int> remap = store_.reorder(order);
+    for(unsigned int& index : topo)
+    {
+        index = remap[index];
+    }
+    topo_.assign(topo);
+    for(unsigned int index = 0; index < store_.size(); ++index)
+    {
+        position_.set(SlotMap::indexOf(store_.id(index)), index);
+    }
+}
+
+void Document::addEdge(unsigned int driverIndex, unsigned int port, unsigned int sinkIndex, unsigned int output)
+{
+    topo_.insertEdge(store_, driverIndex, sinkIndex);
+    store_.setFanin(sinkIndex, port, driverIndex, output);
+    recordEdge(Change::EdgeAdded, driverIndex, port, sinkIndex, output);
+}
+
+void Document::recordEdge(Change::Kind kind, unsigned int driverIndex, unsigned int port, unsigned int sinkIndex,
+                          unsigned int output)
+{
+    journal_.record(Change{ kind, store_.type(sinkIndex), store_.type(sinkIndex), static_cast<unsigned char>(port),
+                            store_.id(sinkIndex), store_.id(driverIndex), static_cast<unsigned char>(output) });
+}
+
 
-} // namespace doc
\ No newline at end of file
+} // namespace doc
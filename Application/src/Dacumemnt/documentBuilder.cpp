@@ -0,0 +1,219 @@
+#include "../../inc/Document/documentBuilder.h"
+#include "../../inc/Document/module.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+
+namespace doc {
+
+
+//////////////////////////////////////////////////////////////
+///DocumentBuilder
+//////////////////////////////////////////////////////////////
+void DocumentBuilder::reserve(unsigned int gateCaunt, unsigned int edgeCaunt)
+{
+    types_.reserve(gateCaunt);
+    edges_.reserve(edgeCaunt);
+}
+
+unsigned int DocumentBuilder::addGate(GateType type, unsigned int id)
+{
+    if(id == Gate::NoGate)
+    {
+        id = slots_.allocate();
+    }
+    else if(!slots_.allocateAt(id))
+    {
+        throw std::invalid_argument("DocumentBuilder: gate id " + std::to_string(id) + " is already taken");
+    }
+    unsigned int index = SlotMap::indexOf(id);
+    if(index >= types_.size())
+    {
+        types_.resize(index + 1, GateType::INPUT);
+    }
+    types_[index] = type;
+    return id;
+}
+
+unsigned int DocumentBuilder::addGate(const Gate &gate)
+{
+    unsigned int id = addGate(gate.getType(), gate.getId());
+    for(unsigned int port = 0; port < gate.getInputCaunt(); ++port)
+    {
+        if(gate.getInputs()[port] != Gate::NoGate)
+        {
+            addEdge(gate.getInputs()[port], port, id, gate.getDriverOutput(port));
+        }
+    }
+    return id;
+}
+
+void DocumentBuilder::addEdge(unsigned int driverId, unsigned int port, unsigned int sinkId, unsigned int output)
+{
+    if(port >= MaxGateInputs)
+    {
+        throw std::out_of_range("DocumentBuilder: input port out of range");
+    }
+    if(output >= MaxGateOutputs)
+    {
+        throw std::out_of_range("DocumentBuilder: driver output out of range");
+    }
+    edges_.push_back(Edge{ driverId, port, sinkId, output });
+}
+
+void DocumentBuilder::addInstance(Instance instance, unsigned int id)
+{
+    instances_.emplace_back(id, std::move(instance));
+}
+
+unsigned int DocumentBuilder::gateCaunt() const
+{
+    return slots_.size();
+}
+
+std::shared_ptr<Document> DocumentBuilder::build(std::shared_ptr<Arena> arena)
+{
+    std::shared_ptr<Document> doc = arena ? std::make_shared<Document>(std::move(arena)) : std::make_shared<Document>();
+    unsigned int slots = slots_.capacity();
+
+    std::vector<unsigned char> pins(slots, 0);
+    unsigned int pinTotal = 0;
+    for(unsigned int index = 0; index < slots; ++index)
+    {
+        if(slots_.idAt(index) != SlotMap::InvalidId)
+        {
+            pins[index] = descriptor(types_[index]).inputCaunt;
+        }
+    }
+    for(const Edge& edge : edges_)
+    {
+        if(!slots_.isValid(edge.sinkId))
+        {
+            throw std::invalid_argument("DocumentBuilder: edge into missing gate " + std::to_string(edge.sinkId));
+        }
+        unsigned char& pin = pins[SlotMap::indexOf(edge.sinkId)];
+        pin = std::max<unsigned char>(pin, edge.port + 1);
+    }
+    for(unsigned char pin : pins)
+    {
+        pinTotal += pin;
+    }
+
+    NetlistStore& store = doc->store_;
+    store.reserve(slots, pinTotal);
+    for(unsigned int index = 0; index < slots; ++index)
+    {
+        unsigned int id = slots_.idAt(index);
+        if(id != SlotMap::InvalidId)
+        {
+            store.placeGate(index, id, types_[index], pins[index]);
+            doc->setPosition(id, index);
+        }
+    }
+    for(const Edge& edge : edges_)
+    {
+        if(slots_.isValid(edge.driverId))
+        {
+            store.initFanin(SlotMap::indexOf(edge.sinkId), edge.port, SlotMap::indexOf(edge.driverId), edge.output);
+        }
+        else
+        {
+            doc->pending_.emplace(edge.driverId, Document::PendingInput{ edge.sinkId, edge.port, edge.output });
+        }
+    }
+    store.rebuildFanout();
+
+    // Kahn: a gate joins the order once all of its drivers are in it.
+    std::vector<unsigned int> waiting(slots, 0);
+    std::vector<unsigned int> order;
+    order.reserve(store.liveCaunt());
+    for(unsigned int index = 0; index < slots; ++index)
+    {
+        if(!store.isAlive(index))
+        {
+            continue;
+        }
+        for(const unsigned int* it = store.faninBegin(index); it != store.faninEnd(index); ++it)
+        {
+            if(*it != NetlistStore::npos)
+            {
+                ++waiting[index];
+            }
+        }
+        if(waiting[index] == 0)
+        {
+            order.push_back(index);
+        }
+    }
+    for(std::size_t next = 0; next < order.size(); ++next)
+    {
+        unsigned int index = order[next];
+        for(unsigned int k = 0; k < store.fanoutCaunt(index); ++k)
+        {
+            unsigned int sink = store.fanoutAt(index, k);
+            if(--waiting[sink] == 0)
+            {
+                order.push_back(sink);
+            }
+        }
+    }
+    if(order.size() != store.liveCaunt())
+    {
+        throw CycleError("DocumentBuilder: netlist has a combinational loop");
+    }
+    doc->topo_.assign(order);
+
+    for(auto& [id, instance] : instances_)
+    {
+        if(!instance.module || instance.outputs.size() != instance.module->outputCaunt())
+        {
+            throw std::invalid_argument("DocumentBuilder: instance " + std::to_string(id) + " does not fit its module");
+        }
+        for(unsigned int wireId : instance.outputs)
+        {
+            if(!slots_.isValid(wireId) || types_[SlotMap::indexOf(wireId)] != GateType::INPUT)
+            {
+                throw std::invalid_argument("DocumentBuilder: instance wire " + std::to_string(wireId) + " is missing");
+            }
+        }
+        instance.inputs.resize(instance.module->inputCaunt(), Gate::NoGate);
+        instance.driverOutputs.resize(instance.inputs.size(), 0);
+        for(unsigned char output : instance.driverOutputs)
+        {
+            if(output >= MaxGateOutputs)
+            {
+                throw std::invalid_argument("DocumentBuilder: instance " + std::to_string(id) + " reads a missing output");
+            }
+        }
+        for(unsigned int driverId : instance.inputs)
+        {
+            if(driverId != Gate::NoGate && !slots_.isValid(driverId))
+            {
+                throw std::invalid_argument("DocumentBuilder: instance input " + std::to_string(driverId) + " is missing");
+            }
+        }
+        if(!doc->instanceSlots_.allocateAt(id))
+        {
+            throw std::invalid_argument("DocumentBuilder: instance id " + std::to_string(id) + " is already taken");
+        }
+        unsigned int index = SlotMap::indexOf(id);
+        if(index >= doc->instances_.size())
+        {
+            doc->instances_.resize(index + 1);
+        }
+        doc->instances_.set(index, std::move(instance));
+    }
+    doc->slots_ = std::move(slots_);
+    doc->slots_.setArena(doc->arena_);
+    // Imported ids say nothing about locality; store the gates in the
+    // order traversals walk them.
+    doc->renumber(GateOrder::Topological);
+
+    *this = DocumentBuilder();
+    return doc;
+}
+
+
+} // namespace doc
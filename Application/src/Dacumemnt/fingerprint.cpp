@@ -0,0 +1,279 @@
+#include "../../inc/Document/fingerprint.h"
+#include "../../inc/Document/module.h"
+
+namespace doc
+{
+
+namespace
+{
+constexpr std::uint64_t GateTag = 0x6761746500000001ull;
+constexpr std::uint64_t InstanceTag = 0x696e737400000002ull;
+constexpr std::uint64_t ConeTag = 0x636f6e6500000003ull;
+constexpr std::uint64_t OpenPort = 0x6f70656e00000004ull;
+
+std::uint64_t scramble(std::uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+std::uint64_t mix(std::uint64_t hash, std::uint64_t value)
+{
+    return scramble(hash ^ (value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2)));
+}
+
+// Past the last connected port. The store keeps a port it grew for an
+// edge after the edge goes, and an undone edit must give back the
+// fingerprint it had, so open ports at the end are left out.
+const unsigned int* connectedEnd(const NetlistStore& store, unsigned int index)
+{
+    const unsigned int* end = store.faninEnd(index);
+    while(end != store.faninBegin(index) && *(end - 1) == NetlistStore::npos)
+    {
+        --end;
+    }
+    return end;
+}
+
+std::uint64_t gateRecord(const NetlistStore& store, unsigned int index)
+{
+    std::uint64_t hash = mix(mix(GateTag, store.id(index)), static_cast<std::uint64_t>(store.type(index)));
+    const unsigned int* begin = store.faninBegin(index);
+    const unsigned int* end = connectedEnd(store, index);
+    for(const unsigned int* it = begin; it != end; ++it)
+    {
+        hash = *it == NetlistStore::npos ? mix(hash, OpenPort)
+                                          : mix(mix(hash, store.id(*it)), store.faninOutput(index, it - begin));
+    }
+    return hash;
+}
+
+std::uint64_t instanceRecord(unsigned int id, const Instance& instance)
+{
+    std::uint64_t hash = mix(mix(InstanceTag, id), instance.module ? instance.module->fingerprint() : 0);
+    for(std::size_t port = 0; port < instance.inputs.size(); ++port)
+    {
+        unsigned int driver = instance.inputs[port];
+        unsigned int output = port < instance.driverOutputs.size() ? instance.driverOutputs[port] : 0;
+        hash = driver == Gate::NoGate ? mix(hash, OpenPort) : mix(mix(hash, driver), output);
+    }
+    for(unsigned int wire : instance.outputs)
+    {
+        hash = mix(hash, wire);
+    }
+    return hash;
+}
+
+void setRecord(std::vector<std::uint64_t>& records, unsigned int slot, std::uint64_t record, std::uint64_t& design)
+{
+    if(slot >= records.size())
+    {
+        records.resize(slot + 1, 0);
+    }
+    design += record - records[slot];
+    records[slot] = record;
+}
+}
+
+
+Fingerprint::Fingerprint(Document &doc)
+    : doc_(doc)
+{
+    rebuild();
+    subscription_ = doc_.journal().subscribe([this](const ChangeBatch& batch) { apply(batch); });
+}
+
+Fingerprint::~Fingerprint()
+{
+    doc_.journal().unsubscribe(subscription_);
+}
+
+std::uint64_t Fingerprint::design() const
+{
+    return design_;
+}
+
+std::uint64_t Fingerprint::cone(unsigned int id) const
+{
+    if(!doc_.contains(id))
+    {
+        return 0;
+    }
+    unsigned int slot = SlotMap::indexOf(id);
+    if(stale_[slot])
+    {
+        return rehash(doc_.indexOf(id));
+    }
+    return cones_[slot];
+}
+
+void Fingerprint::rebuild()
+{
+    const NetlistStore& store = doc_.store();
+    design_ = 0;
+    gates_.clear();
+    instances_.clear();
+    cones_.clear();
+    stale_.clear();
+    for(unsigned int index = 0; index < store.size(); ++index)
+    {
+        if(store.isAlive(index))
+        {
+            updateGate(store.id(index));
+        }
+    }
+    for(unsigned int id : doc_.instanceIds())
+    {
+        updateInstance(id);
+    }
+    cones_.resize(gates_.size(), 0);
+    stale_.assign(gates_.size(), 1);
+}
+
+// Records are taken from the document as it is after the batch, so a
+// change naming a gate that is gone by then is left to its GateRemoved.
+void Fingerprint::apply(const ChangeBatch &batch)
+{
+    for(const Change& change : batch)
+    {
+        switch(change.kind)
+        {
+        case Change::InstanceAdded:
+        case Change::InstanceRemoved:
+        case Change::InstanceBound:
+            if(doc_.containsInstance(change.gate))
+            {
+                updateInstance(change.gate);
+            }
+            else if(change.kind == Change::InstanceRemoved)
+            {
+                setRecord(instances_, SlotMap::indexOf(change.gate), 0, design_);
+            }
+            break;
+        default:
+            if(doc_.contains(change.gate))
+            {
+                updateGate(change.gate);
+                markStale(change.gate);
+            }
+            else if(change.kind == Change::GateRemoved)
+            {
+                setRecord(gates_, SlotMap::indexOf(change.gate), 0, design_);
+            }
+            break;
+        }
+    }
+}
+
+void Fingerprint::updateGate(unsigned int id)
+{
+    setRecord(gates_, SlotMap::indexOf(id), gateRecord(doc_.store(), doc_.indexOf(id)), design_);
+}
+
+void Fingerprint::updateInstance(unsigned int id)
+{
+    setRecord(instances_, SlotMap::indexOf(id), instanceRecord(id, doc_.instance(id)), design_);
+}
+
+void Fingerprint::markStale(unsigned int id)
+{
+    const NetlistStore& store = doc_.store();
+    if(gates_.size() > stale_.size())
+    {
+        cones_.resize(gates_.size(), 0);
+        stale_.resize(gates_.size(), 1);
+    }
+    stack_.assign(1, doc_.indexOf(id));
+    stale_[SlotMap::indexOf(id)] = 0;
+    while(!stack_.empty())
+    {
+        unsigned int node = stack_.back();
+        stack_.pop_back();
+        // A sink added later in the same batch has no record yet.
+        unsigned int slot = SlotMap::indexOf(store.id(node));
+        if(slot >= stale_.size())
+        {
+            cones_.resize(slot + 1, 0);
+            stale_.resize(slot + 1, 1);
+        }
+        unsigned char& stale = stale_[slot];
+        if(stale)
+        {
+            continue;
+        }
+        stale = 1;
+        for(unsigned int k = 0; k < store.fanoutCaunt(node); ++k)
+        {
+            stack_.push_back(store.fanoutAt(node, k));
+        }
+    }
+}
+
+// Post-order over the stale part of the fanin cone.
+std::uint64_t Fingerprint::rehash(unsigned int index) const
+{
+    const NetlistStore& store = doc_.store();
+    auto slotOf = [&store](unsigned int node) { return SlotMap::indexOf(store.id(node)); };
+    stack_.assign(1, index);
+    while(!stack_.empty())
+    {
+        unsigned int node = stack_.back();
+        if(!stale_[slotOf(node)])
+        {
+            stack_.pop_back();
+            continue;
+        }
+        bool ready = true;
+        for(const unsigned int* it = store.faninBegin(node); it != store.faninEnd(node); ++it)
+        {
+            if(*it != NetlistStore::npos && stale_[slotOf(*it)])
+            {
+                stack_.push_back(*it);
+                ready = false;
+            }
+        }
+        if(!ready)
+        {
+            continue;
+        }
+        std::uint64_t hash = mix(ConeTag, static_cast<std::uint64_t>(store.type(node)));
+        if(store.type(node) == GateType::INPUT)
+        {
+            hash = mix(hash, store.id(node));
+        }
+        const unsigned int* begin = store.faninBegin(node);
+        const unsigned int* end = connectedEnd(store, node);
+        for(const unsigned int* it = begin; it != end; ++it)
+        {
+            hash = *it == NetlistStore::npos ? mix(hash, OpenPort)
+                                              : mix(mix(hash, cones_[slotOf(*it)]), store.faninOutput(node, it - begin));
+        }
+        cones_[slotOf(node)] = hash;
+        stale_[slotOf(node)] = 0;
+        stack_.pop_back();
+    }
+    return cones_[SlotMap::indexOf(store.id(index))];
+}
+
+std::uint64_t designFingerprint(const Netlist &netlist)
+{
+    const NetlistStore& store = netlist.store();
+    std::uint64_t design = 0;
+    for(unsigned int index = 0; index < store.size(); ++index)
+    {
+        if(store.isAlive(index))
+        {
+            design += gateRecord(store, index);
+        }
+    }
+    for(unsigned int id : netlist.instanceIds())
+    {
+        design += instanceRecord(id, netlist.instance(id));
+    }
+    return design;
+}
+
+} // namespace doc
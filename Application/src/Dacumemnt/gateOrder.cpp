@@ -0,0 +1,121 @@
+#include "../../inc/Document/gateOrder.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace doc
+{
+
+
+std::vector<unsigned int> depthFirstOrder(const NetlistStore &store)
+{
+    std::vector<unsigned int> order;
+    order.reserve(store.liveCaunt());
+    std::vector<unsigned char> seen(store.size(), 0);
+    // Gate and the next fanin port to look at.
+    std::vector<std::pair<unsigned int, unsigned int>> stack;
+
+    auto visit = [&](unsigned int root)
+    {
+        seen[root] = 1;
+        stack.emplace_back(root, 0);
+        while(!stack.empty())
+        {
+            unsigned int node = stack.back().first;
+            unsigned int& port = stack.back().second;
+            if(port == store.faninCaunt(node))
+            {
+                order.push_back(node);
+                stack.pop_back();
+                continue;
+            }
+            unsigned int driver = store.fanin(node, port++);
+            if(driver != NetlistStore::npos && !seen[driver])
+            {
+                seen[driver] = 1;
+                stack.emplace_back(driver, 0);
+            }
+        }
+    };
+
+    for(unsigned int index = 0; index < store.size(); ++index)
+    {
+        if(store.isAlive(index) && !seen[index] && store.fanoutCaunt(index) == 0)
+        {
+            visit(index);
+        }
+    }
+    // Only gates on a loop are left; there are none in a document.
+    for(unsigned int index = 0; index < store.size(); ++index)
+    {
+        if(store.isAlive(index) && !seen[index])
+        {
+            visit(index);
+        }
+    }
+    return order;
+}
+
+std::vector<unsigned int> cuthillMcKeeOrder(const NetlistStore &store)
+{
+    std::vector<unsigned int> degree(store.size(), 0);
+    std::vector<unsigned int> starts;
+    starts.reserve(store.liveCaunt());
+    for(unsigned int index = 0; index < store.size(); ++index)
+    {
+        if(!store.isAlive(index))
+        {
+            continue;
+        }
+        degree[index] = store.fanoutCaunt(index);
+        for(const unsigned int* it = store.faninBegin(index); it != store.faninEnd(index); ++it)
+        {
+            degree[index] += *it != NetlistStore::npos;
+        }
+        starts.push_back(index);
+    }
+    auto byDegree = [&degree](unsigned int a, unsigned int b) { return degree[a] < degree[b]; };
+    std::stable_sort(starts.begin(), starts.end(), byDegree);
+
+    std::vector<unsigned int> order;
+    order.reserve(store.liveCaunt());
+    std::vector<unsigned char> seen(store.size(), 0);
+    std::vector<unsigned int> next;
+    for(unsigned int start : starts)
+    {
+        if(seen[start])
+        {
+            continue;
+        }
+        seen[start] = 1;
+        order.push_back(start);
+        for(std::size_t head = order.size() - 1; head < order.size(); ++head)
+        {
+            unsigned int node = order[head];
+            next.clear();
+            for(const unsigned int* it = store.faninBegin(node); it != store.faninEnd(node); ++it)
+            {
+                if(*it != NetlistStore::npos && !seen[*it])
+                {
+                    seen[*it] = 1;
+                    next.push_back(*it);
+                }
+            }
+            for(unsigned int k = 0; k < store.fanoutCaunt(node); ++k)
+            {
+                unsigned int sink = store.fanoutAt(node, k);
+                if(!seen[sink])
+                {
+                    seen[sink] = 1;
+                    next.push_back(sink);
+                }
+            }
+            std::stable_sort(next.begin(), next.end(), byDegree);
+            order.insert(order.end(), next.begin(), next.end());
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+} // namespace doc
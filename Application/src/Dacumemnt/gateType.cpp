@@ -0,0 +1,59 @@
+#include "../../inc/Document/gateType.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace doc
+{
+
+namespace
+{
+
+constexpr bool tableIsOrdered()
+{
+    for(unsigned int i = 0; i < GateTypeCaunt; ++i)
+    {
+        if(static_cast<unsigned int>(gateDescriptors[i].type) != i)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(tableIsOrdered(), "gateDescriptors must be indexed by GateType");
+static_assert(evaluate(GateType::AND_3, 0, 0b111) && !evaluate(GateType::AND_3, 0, 0b011), "AND_3 truth table");
+static_assert(evaluate(GateType::MUX_2, 0, 0b110) && !evaluate(GateType::MUX_2, 0, 0b101), "MUX_2 truth table");
+static_assert(evaluate(GateType::FULL_ADDER, 1, 0b110) && !evaluate(GateType::FULL_ADDER, 0, 0b110), "FULL_ADDER truth table");
+
+} // namespace
+
+
+const char *gateTypeName(GateType type)
+{
+    return descriptor(type).name;
+}
+
+const GateDescriptor *findGateDescriptor(const std::string &name)
+{
+    for(const GateDescriptor& desc : gateDescriptors)
+    {
+        if(std::strcmp(desc.name, name.c_str()) == 0)
+        {
+            return &desc;
+        }
+    }
+    return nullptr;
+}
+
+GateType gateTypeFromName(const std::string &name)
+{
+    const GateDescriptor* desc = findGateDescriptor(name);
+    if(desc == nullptr)
+    {
+        throw std::invalid_argument("Unknown gate type: " + name);
+    }
+    return desc->type;
+}
+
+} // namespace doc
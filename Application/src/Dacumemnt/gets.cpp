@@ -1,20 +1,33 @@
 #include "../../inc/Document/gets.h"
 
+#include <stdexcept>
+#include <string>
+
 namespace doc
 {
 
 
-void Gate::setInputs(std::unordered_map<unsigned int, unsigned int> &&inputs)
+Gate::Gate()
+{
+    inputs.fill(NoGate);
+}
+
+void Gate::setInputs(const Inputs &inputs)
+{
+    this->inputs = inputs;
+}
+
+void Gate::setDriverOutputs(const DriverOutputs &outputs)
 {
-    this->inputs = std::move(inputs);
+    driverOutputs = outputs;
 }
 
-void Gate::setConects(std::unordered_set<unsigned int> &&conects)
+void Gate::setConects(Conects &&conects)
 {
     this->conects = std::move(conects);
 }
 
-void Gate::setType(const std::string &type)
+void Gate::setType(GateType type)
 {
     this->type = type;
 }
@@ -24,55 +37,89 @@ void Gate::setId(unsigned int id)
     this->id = id;
 }
 
-void Gate::addInput(unsigned int inputPort, unsigned int ID)
+void Gate::addInput(unsigned int inputPort, unsigned int ID, unsigned int output)
 {
-    this->inputs.emplace(inputPort, ID);
+    if(inputPort >= MaxInputs)
+    {
+        throw std::out_of_range("Gate: input port " + std::to_string(inputPort) + " out of range");
+    }
+    if(output >= MaxGateOutputs)
+    {
+        throw std::out_of_range("Gate: driver output " + std::to_string(output) + " out of range");
+    }
+    this->inputs[inputPort] = ID;
+    driverOutputs[inputPort] = static_cast<unsigned char>(output);
 }
 
 void Gate::removeInput(unsigned int inputPort)
 {
-    auto it = inputs.find(inputPort);
-    inputs.erase(it);
+    if(inputPort < MaxInputs)
+    {
+        inputs[inputPort] = NoGate;
+        driverOutputs[inputPort] = 0;
+    }
 }
 
 void Gate::addConect(unsigned int gateId)
 {
-    conects.emplace(gateId);
+    if(!conects.contains(gateId))
+    {
+        conects.push_back(gateId);
+    }
 }
 
 void Gate::removeConect(unsigned int gateId)
 {
-    conects.erase(gateId);
+    conects.eraseValue(gateId);
 }
 
-std::unordered_set<unsigned int> &Gate::getConects()
+const Gate::Conects &Gate::getConects() const
 {
     return conects;
 }
 
-const std::string &Gate::getType() const
+GateType Gate::getType() const
 {
     return type;
 }
 
-std::unordered_map<unsigned int, unsigned int> &Gate::getInputs()
+const Gate::Inputs &Gate::getInputs() const
 {
     return inputs;
 }
 
-unsigned int Gate::getInput(unsigned int inputPort) const 
+const Gate::DriverOutputs &Gate::getDriverOutputs() const
+{
+    return driverOutputs;
+}
+
+unsigned int Gate::getInput(unsigned int inputPort) const
 {
-    auto it = inputs.find(inputPort);
-    if(it != nullptr)
+    if(inputPort < MaxInputs && inputs[inputPort] != NoGate)
     {
-        return it->second;
+        return inputs[inputPort];
     }
     return 0;
 }
 
+unsigned int Gate::getDriverOutput(unsigned int inputPort) const
+{
+    return inputPort < MaxInputs ? driverOutputs[inputPort] : 0;
+}
+
+unsigned int Gate::getInputCaunt() const
+{
+    unsigned int caunt = MaxInputs;
+    while(caunt > 0 && inputs[caunt - 1] == NoGate)
+    {
+        --caunt;
+    }
+    return caunt;
+}
+
 unsigned int Gate::getId() const
 {
     return id;
 }
-    
+
 } // namespace doc
@@ -0,0 +1,455 @@
+#include "../../inc/Document/module.h"
+#include "../../inc/Document/document.h"
+#include "../../inc/Document/fingerprint.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+
+namespace doc {
+
+namespace
+{
+using IdMap = std::unordered_map<unsigned int, unsigned int>;
+
+// A gate output in the flat document.
+struct Source
+{
+    unsigned int id = Gate::NoGate;
+    unsigned int output = 0;
+};
+
+// Body or netlist gate id -> what stands for it in the flat document.
+// A copied gate keeps its outputs and has output 0 here; a module input
+// (an INPUT, so read on output 0) names the driver output it stands
+// for. Reading output `o` of a mapped gate reads source.output + o.
+using SourceMap = std::unordered_map<unsigned int, Source>;
+
+Source mapped(const SourceMap& map, unsigned int id, unsigned int output = 0)
+{
+    auto it = map.find(id);
+    return it == map.end() ? Source() : Source{ it->second.id, it->second.output + output };
+}
+
+// Moves every sink of `from` over to `to` (open ports if there is no
+// driver) and removes `from`.
+void bypass(Document& flat, unsigned int from, Source to)
+{
+    Net net = flat.net(from);
+    for(const Pin& sink : net.sinks)
+    {
+        if(to.id == Gate::NoGate)
+        {
+            flat.disconnect(sink.port, sink.gateId);
+        }
+        else
+        {
+            flat.connect(to.id, sink.port, sink.gateId, to.output);
+        }
+    }
+    flat.removeaGate(from);
+}
+
+void expandInstances(Document& flat, const Netlist& netlist, const SourceMap& map);
+
+// `local` comes in holding the module inputs and leaves holding every
+// body gate id mapped to its flat id.
+void expandBody(Document& flat, const Module& module, SourceMap& local)
+{
+    const Netlist& body = module.body();
+    for(unsigned int id : body.topologicalOrder())
+    {
+        if(local.count(id) != 0)
+        {
+            continue;
+        }
+        Gate source = body.at(id);
+        Gate copy;
+        copy.setType(source.getType());
+        for(unsigned int port = 0; port < MaxGateInputs; ++port)
+        {
+            Source driver = mapped(local, source.getInputs()[port], source.getDriverOutput(port));
+            if(driver.id != Gate::NoGate)
+            {
+                copy.addInput(port, driver.id, driver.output);
+            }
+        }
+        local[id] = Source{ flat.addGate(copy), 0 };
+    }
+    expandInstances(flat, body, local);
+}
+
+// Wires are bypassed only once every instance is expanded, since an
+// instance input may read the wire of another instance.
+void expandInstances(Document& flat, const Netlist& netlist, const SourceMap& map)
+{
+    std::unordered_map<unsigned int, Source> wireDriver;
+    for(unsigned int instanceId : netlist.instanceIds())
+    {
+        const Instance& instance = netlist.instance(instanceId);
+        const Module& module = *instance.module;
+        SourceMap local;
+        for(unsigned int port = 0; port < module.inputCaunt(); ++port)
+        {
+            unsigned int driver = port < instance.inputs.size() ? instance.inputs[port] : Gate::NoGate;
+            unsigned int output = port < instance.driverOutputs.size() ? instance.driverOutputs[port] : 0;
+            local[module.input(port)] = mapped(map, driver, output);
+        }
+        expandBody(flat, module, local);
+
+        for(unsigned int port = 0; port < module.outputCaunt(); ++port)
+        {
+            unsigned int output = mapped(local, module.output(port)).id;
+            unsigned int wire = port < instance.outputs.size() ? mapped(map, instance.outputs[port]).id : Gate::NoGate;
+            if(wire != Gate::NoGate)
+            {
+                wireDriver[wire] = Source{ flat.driverOf(0, output), flat.driverOutputOf(0, output) };
+            }
+            flat.removeaGate(output);
+        }
+    }
+
+    for(const auto& entry : wireDriver)
+    {
+        // A module output fed straight from an input may name another wire.
+        Source driver = entry.second;
+        for(std::size_t hops = 0; wireDriver.count(driver.id) != 0; ++hops)
+        {
+            if(hops == wireDriver.size())
+            {
+                throw CycleError("flatten: instances feed each other in a loop");
+            }
+            driver = wireDriver.at(driver.id);
+        }
+        bypass(flat, entry.first, driver);
+    }
+}
+}
+
+
+//////////////////////////////////////////////////////////////
+///Module
+//////////////////////////////////////////////////////////////
+Module::Module(std::string name, std::shared_ptr<const Netlist> body, std::string path)
+    : name_(std::move(name)), body_(std::move(body)), path_(std::move(path))
+{
+    if(!body_)
+    {
+        throw std::invalid_argument("Module: no body");
+    }
+    std::unordered_set<unsigned int> wires;
+    for(unsigned int instanceId : body_->instanceIds())
+    {
+        const Instance& instance = body_->instance(instanceId);
+        wires.insert(instance.outputs.begin(), instance.outputs.end());
+        flatGateCaunt_ += instance.module->flatGateCaunt();
+    }
+
+    const NetlistStore& store = body_->store();
+    for(unsigned int index = 0; index < store.size(); ++index)
+    {
+        if(!store.isAlive(index))
+        {
+            continue;
+        }
+        unsigned int id = store.id(index);
+        if(store.type(index) == GateType::OUTPUT)
+        {
+            outputs_.push_back(id);
+        }
+        else if(store.type(index) != GateType::INPUT)
+        {
+            ++flatGateCaunt_;
+        }
+        else if(wires.count(id) == 0)
+        {
+            inputs_.push_back(id);
+        }
+    }
+    auto bySlot = [](unsigned int a, unsigned int b) { return SlotMap::indexOf(a) < SlotMap::indexOf(b); };
+    std::sort(inputs_.begin(), inputs_.end(), bySlot);
+    std::sort(outputs_.begin(), outputs_.end(), bySlot);
+    fingerprint_ = designFingerprint(*body_);
+}
+
+const std::string &Module::name() const
+{
+    return name_;
+}
+
+const std::string &Module::path() const
+{
+    return path_;
+}
+
+const Netlist &Module::body() const
+{
+    return *body_;
+}
+
+unsigned int Module::inputCaunt() const
+{
+    return inputs_.size();
+}
+
+unsigned int Module::outputCaunt() const
+{
+    return outputs_.size();
+}
+
+unsigned int Module::input(unsigned int port) const
+{
+    return inputs_.at(port);
+}
+
+unsigned int Module::output(unsigned int port) const
+{
+    return outputs_.at(port);
+}
+
+unsigned long long Module::flatGateCaunt() const
+{
+    return flatGateCaunt_;
+}
+
+std::uint64_t Module::fingerprint() const
+{
+    return fingerprint_;
+}
+
+
+
+//////////////////////////////////////////////////////////////
+///Flatten
+//////////////////////////////////////////////////////////////
+std::shared_ptr<Document> flatten(const Netlist &netlist, std::shared_ptr<Arena> arena)
+{
+    std::shared_ptr<Document> flat = arena ? std::make_shared<Document>(std::move(arena)) : std::make_shared<Document>();
+    SourceMap same;
+    for(unsigned int id : netlist.topologicalOrder())
+    {
+        same[id] = Source{ flat->addGate(netlist.at(id)), 0 };
+    }
+    expandInstances(*flat, netlist, same);
+    return flat;
+}
+
+
+
+//////////////////////////////////////////////////////////////
+///Extract
+//////////////////////////////////////////////////////////////
+namespace
+{
+constexpr unsigned int OpenToken = 0x100;
+constexpr unsigned int LeafToken = 0x200;
+constexpr unsigned int MaxConeGates = 256;
+
+// A fanout-free cone: a root gate and the gates that feed nothing but
+// it, directly or through each other. Leaves are the gates outside the
+// cone that it reads.
+struct Cone
+{
+    std::vector<unsigned int> key;
+    std::vector<unsigned int> gates;    // preorder from the root
+    std::vector<unsigned int> leaves;   // in order of first use
+    std::vector<unsigned int> leafOutputs;  // output of each leaf read
+};
+
+struct KeyHash
+{
+    std::size_t operator()(const std::vector<unsigned int>& key) const
+    {
+        std::size_t hash = key.size();
+        for(unsigned int token : key)
+        {
+            hash = (hash * 1000003) ^ token;
+        }
+        return hash;
+    }
+};
+
+// Cones are made of gates with one output, so the module output is the
+// root's. `instanceRead` marks, by store index, the gates an instance
+// input reads; they drive more than their one sink.
+bool foldable(GateType type)
+{
+    return type != GateType::INPUT && type != GateType::OUTPUT && descriptor(type).outputCaunt == 1;
+}
+
+bool isInner(const NetlistStore& store, const std::vector<unsigned char>& instanceRead, unsigned int index)
+{
+    return foldable(store.type(index)) && store.fanoutCaunt(index) == 1
+           && store.type(store.fanoutAt(index, 0)) != GateType::OUTPUT && !instanceRead[index];
+}
+
+// Walks the cone depth first, port by port. The key lists the type of
+// each gate reached and, per port, OpenToken, LeafToken plus the leaf
+// number, or the key of the driving gate, so equal keys mean
+// isomorphic cones. False for cones over MaxConeGates gates.
+bool shapeOf(const NetlistStore& store, const std::vector<unsigned char>& instanceRead, unsigned int root, Cone& cone)
+{
+    cone.key.assign(1, static_cast<unsigned int>(store.type(root)));
+    cone.gates.assign(1, root);
+    cone.leaves.clear();
+    cone.leafOutputs.clear();
+    std::vector<std::pair<unsigned int, unsigned int>> stack{ { root, 0 } };
+    while(!stack.empty())
+    {
+        unsigned int node = stack.back().first;
+        unsigned int port = stack.back().second++;
+        if(port == store.faninCaunt(node))
+        {
+            stack.pop_back();
+            continue;
+        }
+        unsigned int driver = store.fanin(node, port);
+        if(driver == NetlistStore::npos)
+        {
+            cone.key.push_back(OpenToken);
+        }
+        else if(isInner(store, instanceRead, driver))
+        {
+            if(cone.gates.size() == MaxConeGates)
+            {
+                return false;
+            }
+            cone.key.push_back(static_cast<unsigned int>(store.type(driver)));
+            cone.gates.push_back(driver);
+            stack.emplace_back(driver, 0);
+        }
+        else
+        {
+            // A leaf is a driver output; the sum and carry of an adder are two.
+            unsigned int output = store.faninOutput(node, port);
+            std::size_t leaf = 0;
+            while(leaf < cone.leaves.size() && (cone.leaves[leaf] != driver || cone.leafOutputs[leaf] != output))
+            {
+                ++leaf;
+            }
+            cone.key.push_back(LeafToken + leaf);
+            if(leaf == cone.leaves.size())
+            {
+                cone.leaves.push_back(driver);
+                cone.leafOutputs.push_back(output);
+            }
+        }
+    }
+    return true;
+}
+
+// Body: one INPUT per leaf, the cone, and an OUTPUT fed by the root.
+std::shared_ptr<const Module> makeModule(const NetlistStore& store, const Cone& cone, std::string name)
+{
+    Document body;
+    std::vector<unsigned int> inputIds;
+    for(std::size_t leaf = 0; leaf < cone.leaves.size(); ++leaf)
+    {
+        Gate input;
+        input.setType(GateType::INPUT);
+        inputIds.push_back(body.addGate(input));
+    }
+    auto inputOf = [&](unsigned int driver, unsigned int output)
+    {
+        std::size_t leaf = 0;
+        while(cone.leaves[leaf] != driver || cone.leafOutputs[leaf] != output)
+        {
+            ++leaf;
+        }
+        return inputIds[leaf];
+    };
+    // Reverse preorder puts every gate after the gates feeding it.
+    IdMap bodyId;
+    for(auto it = cone.gates.rbegin(); it != cone.gates.rend(); ++it)
+    {
+        Gate gate;
+        gate.setType(store.type(*it));
+        for(unsigned int port = 0; port < store.faninCaunt(*it); ++port)
+        {
+            unsigned int driver = store.fanin(*it, port);
+            if(driver == NetlistStore::npos)
+            {
+                continue;
+            }
+            auto inner = bodyId.find(driver);
+            gate.addInput(port, inner != bodyId.end() ? inner->second : inputOf(driver, store.faninOutput(*it, port)));
+        }
+        bodyId[*it] = body.addGate(gate);
+    }
+    Gate output;
+    output.setType(GateType::OUTPUT);
+    output.addInput(0, bodyId.at(cone.gates.front()));
+    body.addGate(output);
+    return std::make_shared<const Module>(std::move(name), body.snapshot());
+}
+}
+
+std::vector<FoldedCone> findModules(const Netlist &netlist, unsigned int minGates, unsigned int minCaunt)
+{
+    const NetlistStore& store = netlist.store();
+    std::vector<unsigned char> instanceRead(store.size(), 0);
+    for(unsigned int instanceId : netlist.instanceIds())
+    {
+        for(unsigned int driverId : netlist.instance(instanceId).inputs)
+        {
+            if(netlist.contains(driverId))
+            {
+                instanceRead[netlist.indexOf(driverId)] = 1;
+            }
+        }
+    }
+
+    struct Group
+    {
+        unsigned int caunt = 0;
+        std::shared_ptr<const Module> module;
+    };
+    std::unordered_map<std::vector<unsigned int>, Group, KeyHash> groups;
+    std::vector<std::pair<unsigned int, Group*>> roots;
+    Cone cone;
+    for(unsigned int index : netlist.topoOrder().order())
+    {
+        if(!foldable(store.type(index)) || isInner(store, instanceRead, index))
+        {
+            continue;
+        }
+        if(shapeOf(store, instanceRead, index, cone) && cone.gates.size() >= std::max(minGates, 1u))
+        {
+            Group& group = groups[cone.key];
+            ++group.caunt;
+            roots.emplace_back(index, &group);
+        }
+    }
+
+    std::vector<FoldedCone> cones;
+    unsigned int moduleCaunt = 0;
+    auto idsOf = [&store](std::vector<unsigned int> indices)
+    {
+        for(unsigned int& index : indices)
+        {
+            index = store.id(index);
+        }
+        return indices;
+    };
+    for(const auto& root : roots)
+    {
+        Group& group = *root.second;
+        if(group.caunt < std::max(minCaunt, 1u))
+        {
+            continue;
+        }
+        shapeOf(store, instanceRead, root.first, cone);
+        if(!group.module)
+        {
+            group.module = makeModule(store, cone, "extracted" + std::to_string(moduleCaunt++));
+        }
+        cones.push_back(FoldedCone{ store.id(root.first), idsOf(cone.gates), idsOf(cone.leaves), cone.leafOutputs, group.module });
+    }
+    return cones;
+}
+
+
+} // namespace doc
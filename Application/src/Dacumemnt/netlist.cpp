@@ -0,0 +1,289 @@
+#include "../../inc/Document/netlist.h"
+
+#include <stdexcept>
+#include <string>
+
+
+namespace doc {
+
+
+//////////////////////////////////////////////////////////////
+///Netlist iterator
+//////////////////////////////////////////////////////////////
+Netlist::iterator::iterator(const Netlist *netlist, unsigned int index)
+    : netlist_(netlist), index_(index)
+{
+    skipDead();
+}
+
+Gate Netlist::iterator::operator*() const
+{
+    return netlist_->makeGate(index_);
+}
+
+Netlist::iterator &Netlist::iterator::operator++()
+{
+    ++index_;
+    skipDead();
+    return *this;
+}
+
+bool Netlist::iterator::operator==(const iterator &other) const
+{
+    return index_ == other.index_ && netlist_ == other.netlist_;
+}
+
+bool Netlist::iterator::operator!=(const iterator &other) const
+{
+    return !(*this == other);
+}
+
+unsigned int Netlist::iterator::index() const
+{
+    return index_;
+}
+
+void Netlist::iterator::skipDead()
+{
+    const NetlistStore& store = netlist_->store_;
+    while(index_ < store.size() && !store.isAlive(index_))
+    {
+        ++index_;
+    }
+}
+
+
+
+//////////////////////////////////////////////////////////////
+///Netlist
+//////////////////////////////////////////////////////////////
+Netlist::Netlist()
+    : Netlist(std::make_shared<Arena>())
+{
+}
+
+Netlist::Netlist(std::shared_ptr<Arena> arena)
+    : arena_(std::move(arena))
+{
+    store_.setArena(arena_);
+    slots_.setArena(arena_);
+    position_.setArena(arena_);
+    topo_.setArena(arena_);
+    instances_.setArena(arena_);
+    instanceSlots_.setArena(arena_);
+}
+
+Netlist::iterator Netlist::begin() const
+{
+    return iterator(this, 0);
+}
+
+Netlist::iterator Netlist::end() const
+{
+    return iterator(this, store_.size());
+}
+
+Netlist::iterator Netlist::find(unsigned int id) const
+{
+    if(!contains(id))
+    {
+        return end();
+    }
+    return iterator(this, indexOf(id));
+}
+
+Gate Netlist::at(unsigned int id) const
+{
+    return makeGate(indexOf(id));
+}
+
+GateType Netlist::typeOf(unsigned int id) const
+{
+    return store_.type(indexOf(id));
+}
+
+unsigned int Netlist::driverOf(unsigned int port, unsigned int sinkId) const
+{
+    unsigned int driver = store_.fanin(indexOf(sinkId), port);
+    return driver == NetlistStore::npos ? Gate::NoGate : store_.id(driver);
+}
+
+unsigned int Netlist::driverOutputOf(unsigned int port, unsigned int sinkId) const
+{
+    return store_.faninOutput(indexOf(sinkId), port);
+}
+
+Gate::Inputs Netlist::inputsOf(unsigned int id) const
+{
+    unsigned int index = indexOf(id);
+    Gate::Inputs inputs;
+    inputs.fill(Gate::NoGate);
+    for(unsigned int port = 0; port < store_.faninCaunt(index); ++port)
+    {
+        unsigned int driver = store_.fanin(index, port);
+        if(driver != NetlistStore::npos)
+        {
+            inputs[port] = store_.id(driver);
+        }
+    }
+    return inputs;
+}
+
+Gate::DriverOutputs Netlist::driverOutputsOf(unsigned int id) const
+{
+    unsigned int index = indexOf(id);
+    Gate::DriverOutputs outputs{};
+    for(unsigned int port = 0; port < store_.faninCaunt(index); ++port)
+    {
+        outputs[port] = static_cast<unsigned char>(store_.faninOutput(index, port));
+    }
+    return outputs;
+}
+
+Net Netlist::net(unsigned int driverId, unsigned int output) const
+{
+    Net net{ driverId, {}, output };
+    unsigned int index = indexOf(driverId);
+    net.sinks.reserve(store_.fanoutCaunt(index));
+    for(unsigned int k = 0; k < store_.fanoutCaunt(index); ++k)
+    {
+        if(store_.fanoutOutput(index, k) == output)
+        {
+            net.sinks.push_back(Pin{ store_.id(store_.fanoutAt(index, k)), store_.fanoutPort(index, k) });
+        }
+    }
+    return net;
+}
+
+std::vector<Net> Netlist::nets(unsigned int driverId) const
+{
+    std::vector<Net> nets;
+    for(unsigned int output = 0; output < MaxGateOutputs; ++output)
+    {
+        Net net = this->net(driverId, output);
+        if(!net.sinks.empty())
+        {
+            nets.push_back(std::move(net));
+        }
+    }
+    return nets;
+}
+
+bool Netlist::contains(unsigned int id) const
+{
+    return slots_.isValid(id);
+}
+
+unsigned int Netlist::size() const
+{
+    return store_.liveCaunt();
+}
+
+unsigned int Netlist::indexOf(unsigned int id) const
+{
+    if(!contains(id))
+    {
+        throw std::out_of_range("Netlist: no gate with id " + std::to_string(id));
+    }
+    return position_[SlotMap::indexOf(id)];
+}
+
+const NetlistStore &Netlist::store() const
+{
+    return store_;
+}
+
+const TopoOrder &Netlist::topoOrder() const
+{
+    return topo_;
+}
+
+std::vector<unsigned int> Netlist::topologicalOrder() const
+{
+    std::vector<unsigned int> order = topo_.order();
+    for(unsigned int& index : order)
+    {
+        index = store_.id(index);
+    }
+    return order;
+}
+
+std::size_t Netlist::bytesApartFrom(const Netlist &other) const
+{
+    return store_.bytesApartFrom(other.store_) + slots_.bytesApartFrom(other.slots_)
+           + position_.bytesApartFrom(other.position_) + topo_.bytesApartFrom(other.topo_)
+           + instances_.bytesApartFrom(other.instances_) + instanceSlots_.bytesApartFrom(other.instanceSlots_);
+}
+
+std::size_t Netlist::detachedBytes() const
+{
+    return store_.detachedBytes() + slots_.detachedBytes() + position_.detachedBytes() + topo_.detachedBytes()
+           + instances_.detachedBytes() + instanceSlots_.detachedBytes();
+}
+
+const Instance &Netlist::instance(unsigned int id) const
+{
+    if(!containsInstance(id))
+    {
+        throw std::out_of_range("Netlist: no instance with id " + std::to_string(id));
+    }
+    return instances_[SlotMap::indexOf(id)];
+}
+
+bool Netlist::containsInstance(unsigned int id) const
+{
+    return instanceSlots_.isValid(id);
+}
+
+unsigned int Netlist::instanceCaunt() const
+{
+    return instanceSlots_.size();
+}
+
+std::vector<unsigned int> Netlist::instanceIds() const
+{
+    std::vector<unsigned int> ids;
+    ids.reserve(instanceSlots_.size());
+    for(unsigned int index = 0; index < instanceSlots_.capacity(); ++index)
+    {
+        unsigned int id = instanceSlots_.idAt(index);
+        if(id != SlotMap::InvalidId)
+        {
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
+
+void Netlist::setPosition(unsigned int id, unsigned int index)
+{
+    unsigned int slot = SlotMap::indexOf(id);
+    if(slot >= position_.size())
+    {
+        position_.resize(slot + 1, NetlistStore::npos);
+    }
+    position_.set(slot, index);
+}
+
+Gate Netlist::makeGate(unsigned int index) const
+{
+    Gate gate;
+    gate.setId(store_.id(index));
+    gate.setType(store_.type(index));
+    for(unsigned int port = 0; port < store_.faninCaunt(index); ++port)
+    {
+        unsigned int driver = store_.fanin(index, port);
+        if(driver != NetlistStore::npos)
+        {
+            gate.addInput(port, store_.id(driver), store_.faninOutput(index, port));
+        }
+    }
+    for(unsigned int k = 0; k < store_.fanoutCaunt(index); ++k)
+    {
+        gate.addConect(store_.id(store_.fanoutAt(index, k)));
+    }
+    return gate;
+}
+
+
+} // namespace doc
@@ -0,0 +1,477 @@
+#include "../../inc/Document/netlistStore.h"
+
+#include <algorithm>
+
+namespace doc
+{
+
+
+unsigned int NetlistStore::addGate(unsigned int id, GateType type, unsigned int pinCaunt)
+{
+    unsigned int index = size();
+    placeGate(index, id, type, pinCaunt);
+    return index;
+}
+
+void NetlistStore::placeGate(unsigned int index, unsigned int id, GateType type, unsigned int pinCaunt)
+{
+    if(index >= size())
+    {
+        unsigned int slots = index + 1;
+        types_.resize(slots, GateType::INPUT);
+        ids_.resize(slots, npos);
+        alive_.resize(slots, 0);
+        faninOffset_.resize(slots, 0);
+        faninSize_.resize(slots, 0);
+        fanoutOffset_.resize(slots, 0);
+        fanoutSize_.resize(slots, 0);
+        fanoutRoom_.resize(slots, 0);
+    }
+    else if(alive_[index])
+    {
+        removeGate(index);
+    }
+    faninHoles_ += faninSize_[index];
+    types_.set(index, type);
+    ids_.set(index, id);
+    alive_.set(index, 1);
+    faninOffset_.set(index, allocFanin(fanin_, faninOutput_, pinCaunt, faninHoles_));
+    faninSize_.set(index, pinCaunt);
+    ++liveCaunt_;
+    if(faninHoles_ > fanin_.size() / 2)
+    {
+        compactFanin();
+    }
+}
+
+void NetlistStore::removeGate(unsigned int index)
+{
+    if(!isAlive(index))
+    {
+        return;
+    }
+    for(unsigned int port = 0; port < faninSize_[index]; ++port)
+    {
+        clearFanin(index, port);
+    }
+    // Each fanout entry is one port of a sink still driven by this gate.
+    for(unsigned int k = 0; k < fanoutSize_[index]; ++k)
+    {
+        unsigned int slot = faninOffset_[fanoutAt(index, k)] + fanoutPort(index, k);
+        fanin_.set(slot, npos);
+        faninOutput_.set(slot, 0);
+    }
+    fanoutHoles_ += fanoutRoom_[index];
+    fanoutSize_.set(index, 0);
+    fanoutRoom_.set(index, 0);
+    alive_.set(index, 0);
+    --liveCaunt_;
+}
+
+void NetlistStore::clear()
+{
+    std::shared_ptr<Arena> arena = ids_.arena();
+    *this = NetlistStore();
+    setArena(arena);
+}
+
+void NetlistStore::setFanin(unsigned int index, unsigned int port, unsigned int driver, unsigned int output)
+{
+    if(port >= faninSize_[index])
+    {
+        growFanin(index, port + 1);
+        if(faninHoles_ > fanin_.size() / 2)
+        {
+            compactFanin();
+        }
+    }
+    unsigned int previous = fanin(index, port);
+    unsigned int previousOutput = faninOutput(index, port);
+    if(driver == npos)
+    {
+        output = 0;
+    }
+    if(previous == driver && previousOutput == output)
+    {
+        return;
+    }
+    if(previous != npos)
+    {
+        removeSink(previous, index, port, previousOutput);
+    }
+    fanin_.set(faninOffset_[index] + port, driver);
+    faninOutput_.set(faninOffset_[index] + port, static_cast<unsigned char>(output));
+    if(driver != npos)
+    {
+        addSink(driver, index, port, output);
+    }
+}
+
+void NetlistStore::clearFanin(unsigned int index, unsigned int port)
+{
+    unsigned int previous = fanin(index, port);
+    if(previous != npos)
+    {
+        unsigned int output = faninOutput(index, port);
+        fanin_.set(faninOffset_[index] + port, npos);
+        faninOutput_.set(faninOffset_[index] + port, 0);
+        removeSink(previous, index, port, output);
+    }
+}
+
+void NetlistStore::setType(unsigned int index, GateType type)
+{
+    types_.set(index, type);
+}
+
+unsigned int NetlistStore::size() const
+{
+    return ids_.size();
+}
+
+unsigned int NetlistStore::liveCaunt() const
+{
+    return liveCaunt_;
+}
+
+bool NetlistStore::isAlive(unsigned int index) const
+{
+    return index < alive_.size() && alive_[index];
+}
+
+unsigned int NetlistStore::id(unsigned int index) const
+{
+    return ids_[index];
+}
+
+GateType NetlistStore::type(unsigned int index) const
+{
+    return types_[index];
+}
+
+unsigned int NetlistStore::faninCaunt(unsigned int index) const
+{
+    return faninSize_[index];
+}
+
+unsigned int NetlistStore::fanin(unsigned int index, unsigned int port) const
+{
+    if(port >= faninSize_[index])
+    {
+        return npos;
+    }
+    return fanin_[faninOffset_[index] + port];
+}
+
+unsigned int NetlistStore::faninOutput(unsigned int index, unsigned int port) const
+{
+    if(port >= faninSize_[index])
+    {
+        return 0;
+    }
+    return faninOutput_[faninOffset_[index] + port];
+}
+
+const unsigned int *NetlistStore::faninBegin(unsigned int index) const
+{
+    return faninSize_[index] == 0 ? nullptr : fanin_.ptr(faninOffset_[index]);
+}
+
+const unsigned int *NetlistStore::faninEnd(unsigned int index) const
+{
+    return faninBegin(index) + faninSize_[index];
+}
+
+unsigned int NetlistStore::fanoutCaunt(unsigned int index) const
+{
+    return fanoutSize_[index];
+}
+
+unsigned int NetlistStore::fanoutAt(unsigned int index, unsigned int k) const
+{
+    return fanout_[fanoutOffset_[index] + k] >> (PortBits + OutputBits);
+}
+
+unsigned int NetlistStore::fanoutPort(unsigned int index, unsigned int k) const
+{
+    return fanout_[fanoutOffset_[index] + k] & ((1u << PortBits) - 1);
+}
+
+unsigned int NetlistStore::fanoutOutput(unsigned int index, unsigned int k) const
+{
+    return (fanout_[fanoutOffset_[index] + k] >> PortBits) & ((1u << OutputBits) - 1);
+}
+
+void NetlistStore::initFanin(unsigned int index, unsigned int port, unsigned int driver, unsigned int output)
+{
+    fanin_.set(faninOffset_[index] + port, driver);
+    faninOutput_.set(faninOffset_[index] + port, static_cast<unsigned char>(output));
+}
+
+// Counting pass over fanin: sizes first, then every block is filled in
+// place with no spare room.
+void NetlistStore::rebuildFanout()
+{
+    unsigned int n = size();
+    std::vector<unsigned int> next(n + 1, 0);
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        if(!alive_[i])
+        {
+            continue;
+        }
+        for(const unsigned int* it = faninBegin(i); it != faninEnd(i); ++it)
+        {
+            if(*it != npos)
+            {
+                ++next[*it + 1];
+            }
+        }
+    }
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        fanoutOffset_.set(i, next[i]);
+        fanoutSize_.set(i, next[i + 1]);
+        fanoutRoom_.set(i, next[i + 1]);
+        next[i + 1] += next[i];
+    }
+    fanout_.clear();
+    fanout_.resize(next[n], npos);
+    fanoutHoles_ = 0;
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        if(!alive_[i])
+        {
+            continue;
+        }
+        for(unsigned int port = 0; port < faninSize_[i]; ++port)
+        {
+            unsigned int driver = fanin(i, port);
+            if(driver != npos)
+            {
+                fanout_.set(next[driver]++, makePin(i, port, faninOutput(i, port)));
+            }
+        }
+    }
+}
+
+std::vector<unsigned int> NetlistStore::reorder(const std::vector<unsigned int> &order)
+{
+    std::vector<unsigned int> remap(size(), npos);
+    for(unsigned int k = 0; k < order.size(); ++k)
+    {
+        remap[order[k]] = k;
+    }
+
+    NetlistStore packed;
+    packed.setArena(ids_.arena());
+    packed.reserve(order.size(), fanin_.size() - faninHoles_);
+    for(unsigned int old : order)
+    {
+        packed.addGate(ids_[old], types_[old], faninSize_[old]);
+    }
+    for(unsigned int k = 0; k < order.size(); ++k)
+    {
+        for(unsigned int port = 0; port < faninSize_[order[k]]; ++port)
+        {
+            unsigned int driver = fanin(order[k], port);
+            if(driver != npos && remap[driver] != npos)
+            {
+                packed.initFanin(k, port, remap[driver], faninOutput(order[k], port));
+            }
+        }
+    }
+    packed.rebuildFanout();
+    *this = std::move(packed);
+    return remap;
+}
+
+std::vector<unsigned int> NetlistStore::compact()
+{
+    std::vector<unsigned int> order;
+    order.reserve(liveCaunt_);
+    for(unsigned int i = 0; i < size(); ++i)
+    {
+        if(alive_[i])
+        {
+            order.push_back(i);
+        }
+    }
+    return reorder(order);
+}
+
+void NetlistStore::reserve(unsigned int gateCaunt, unsigned int faninCaunt)
+{
+    types_.reserve(gateCaunt);
+    ids_.reserve(gateCaunt);
+    alive_.reserve(gateCaunt);
+    faninOffset_.reserve(gateCaunt);
+    faninSize_.reserve(gateCaunt);
+    fanoutOffset_.reserve(gateCaunt);
+    fanoutSize_.reserve(gateCaunt);
+    fanoutRoom_.reserve(gateCaunt);
+    fanin_.reserve(faninCaunt);
+    faninOutput_.reserve(faninCaunt);
+    fanout_.reserve(faninCaunt);
+}
+
+void NetlistStore::setArena(const std::shared_ptr<Arena> &arena)
+{
+    types_.setArena(arena);
+    ids_.setArena(arena);
+    alive_.setArena(arena);
+    faninOffset_.setArena(arena);
+    faninSize_.setArena(arena);
+    fanin_.setArena(arena);
+    faninOutput_.setArena(arena);
+    fanoutOffset_.setArena(arena);
+    fanoutSize_.setArena(arena);
+    fanoutRoom_.setArena(arena);
+    fanout_.setArena(arena);
+}
+
+std::size_t NetlistStore::bytesApartFrom(const NetlistStore &other) const
+{
+    return types_.bytesApartFrom(other.types_) + ids_.bytesApartFrom(other.ids_) + alive_.bytesApartFrom(other.alive_)
+           + faninOffset_.bytesApartFrom(other.faninOffset_) + faninSize_.bytesApartFrom(other.faninSize_)
+           + fanin_.bytesApartFrom(other.fanin_) + faninOutput_.bytesApartFrom(other.faninOutput_)
+           + fanoutOffset_.bytesApartFrom(other.fanoutOffset_)
+           + fanoutSize_.bytesApartFrom(other.fanoutSize_) + fanoutRoom_.bytesApartFrom(other.fanoutRoom_)
+           + fanout_.bytesApartFrom(other.fanout_);
+}
+
+std::size_t NetlistStore::detachedBytes() const
+{
+    return types_.detachedBytes() + ids_.detachedBytes() + alive_.detachedBytes() + faninOffset_.detachedBytes()
+           + faninSize_.detachedBytes() + fanin_.detachedBytes() + faninOutput_.detachedBytes()
+           + fanoutOffset_.detachedBytes()
+           + fanoutSize_.detachedBytes() + fanoutRoom_.detachedBytes() + fanout_.detachedBytes();
+}
+
+// Appends a block of unconnected fanin slots, padding to the next chunk
+// when the block would not fit in the current one.
+unsigned int NetlistStore::allocFanin(FaninArray &fanin, OutputArray &outputs, unsigned int pinCaunt, unsigned int &holes)
+{
+    if(pinCaunt > fanin.roomInChunk())
+    {
+        holes += fanin.roomInChunk();
+        outputs.append(fanin.roomInChunk(), 0);
+        fanin.append(fanin.roomInChunk(), npos);
+    }
+    unsigned int offset = fanin.size();
+    fanin.append(pinCaunt, npos);
+    outputs.append(pinCaunt, 0);
+    return offset;
+}
+
+// Moves the fanin block of a gate to the end of the flat array; the old
+// block becomes a hole that compactFanin() reclaims.
+void NetlistStore::growFanin(unsigned int index, unsigned int pinCaunt)
+{
+    unsigned int oldOffset = faninOffset_[index];
+    unsigned int oldSize = faninSize_[index];
+    unsigned int offset = allocFanin(fanin_, faninOutput_, pinCaunt, faninHoles_);
+    for(unsigned int port = 0; port < oldSize; ++port)
+    {
+        fanin_.set(offset + port, fanin_[oldOffset + port]);
+        faninOutput_.set(offset + port, faninOutput_[oldOffset + port]);
+    }
+    faninHoles_ += oldSize;
+    faninOffset_.set(index, offset);
+    faninSize_.set(index, pinCaunt);
+}
+
+// Packs fanin blocks back to back in index order; indices do not change.
+void NetlistStore::compactFanin()
+{
+    FaninArray fanin(fanin_.arena());
+    OutputArray outputs(faninOutput_.arena());
+    unsigned int holes = 0;
+    fanin.reserve(fanin_.size() - faninHoles_);
+    outputs.reserve(fanin_.size() - faninHoles_);
+    for(unsigned int i = 0; i < size(); ++i)
+    {
+        if(!alive_[i])
+        {
+            if(faninSize_[i] != 0)
+            {
+                faninSize_.set(i, 0);
+            }
+            continue;
+        }
+        unsigned int offset = allocFanin(fanin, outputs, faninSize_[i], holes);
+        for(unsigned int port = 0; port < faninSize_[i]; ++port)
+        {
+            fanin.set(offset + port, fanin_[faninOffset_[i] + port]);
+            outputs.set(offset + port, faninOutput_[faninOffset_[i] + port]);
+        }
+        faninOffset_.set(i, offset);
+    }
+    fanin_ = std::move(fanin);
+    faninOutput_ = std::move(outputs);
+    faninHoles_ = holes;
+}
+
+void NetlistStore::addSink(unsigned int driver, unsigned int sink, unsigned int port, unsigned int output)
+{
+    unsigned int size = fanoutSize_[driver];
+    if(size == fanoutRoom_[driver])
+    {
+        unsigned int room = std::max(2u, size * 2);
+        unsigned int oldOffset = fanoutOffset_[driver];
+        unsigned int offset = fanout_.size();
+        fanout_.append(room, npos);
+        for(unsigned int k = 0; k < size; ++k)
+        {
+            fanout_.set(offset + k, fanout_[oldOffset + k]);
+        }
+        fanoutHoles_ += fanoutRoom_[driver];
+        fanoutOffset_.set(driver, offset);
+        fanoutRoom_.set(driver, room);
+    }
+    fanout_.set(fanoutOffset_[driver] + size, makePin(sink, port, output));
+    fanoutSize_.set(driver, size + 1);
+    if(fanoutHoles_ > fanout_.size() / 2)
+    {
+        compactFanout();
+    }
+}
+
+// The last entry takes the place of the removed one.
+void NetlistStore::removeSink(unsigned int driver, unsigned int sink, unsigned int port, unsigned int output)
+{
+    unsigned int offset = fanoutOffset_[driver];
+    unsigned int last = fanoutSize_[driver] - 1;
+    unsigned int pin = makePin(sink, port, output);
+    for(unsigned int k = 0; k <= last; ++k)
+    {
+        if(fanout_[offset + k] == pin)
+        {
+            fanout_.set(offset + k, fanout_[offset + last]);
+            fanoutSize_.set(driver, last);
+            return;
+        }
+    }
+}
+
+// Packs fanout blocks back to back with no spare room; the next sink
+// added to a gate moves its block to the end again.
+void NetlistStore::compactFanout()
+{
+    CowVector<unsigned int> fanout(fanout_.arena());
+    fanout.reserve(fanout_.size() - fanoutHoles_);
+    for(unsigned int i = 0; i < size(); ++i)
+    {
+        unsigned int offset = fanout.size();
+        for(unsigned int k = 0; k < fanoutSize_[i]; ++k)
+        {
+            fanout.push_back(fanout_[fanoutOffset_[i] + k]);
+        }
+        fanoutOffset_.set(i, offset);
+        fanoutRoom_.set(i, fanoutSize_[i]);
+    }
+    fanout_ = std::move(fanout);
+    fanoutHoles_ = 0;
+}
+
+} // namespace doc
@@ -0,0 +1,285 @@
+#include "../../inc/Document/reachIndex.h"
+
+#include <utility>
+
+namespace doc
+{
+
+
+ReachIndex::ReachIndex(Document &doc)
+    : doc_(doc)
+{
+    rebuild();
+    subscription_ = doc_.journal().subscribe([this](const ChangeBatch& batch) { apply(batch); });
+}
+
+ReachIndex::~ReachIndex()
+{
+    doc_.journal().unsubscribe(subscription_);
+}
+
+bool ReachIndex::reaches(unsigned int fromId, unsigned int toId) const
+{
+    if(!doc_.contains(fromId) || !doc_.contains(toId))
+    {
+        return false;
+    }
+    if(fromId == toId)
+    {
+        return true;
+    }
+    const NetlistStore& store = doc_.store();
+    const TopoOrder& topo = doc_.topoOrder();
+    unsigned int target = doc_.indexOf(toId);
+    Label down = down_[slotOf(target)];
+    Label up = up_[slotOf(target)];
+    auto mayReach = [&](unsigned int index)
+    {
+        unsigned int slot = slotOf(index);
+        return topo.precedes(index, target) && (down_[slot] & down) == down && (up_[slot] & ~up) == 0;
+    };
+    const Interval* inner = nullptr;
+    unsigned int targetSlot = SlotMap::indexOf(toId);
+    if(forestValid_ && targetSlot < forest_.size() && forest_[targetSlot].id == toId)
+    {
+        inner = &forest_[targetSlot];
+    }
+    auto covers = [&](unsigned int index)
+    {
+        const Interval& outer = forest_[slotOf(index)];
+        return inner && outer.id == store.id(index) && outer.first <= inner->first && inner->first <= outer.last;
+    };
+
+    unsigned int source = doc_.indexOf(fromId);
+    if(!mayReach(source))
+    {
+        return false;
+    }
+    if(covers(source))
+    {
+        return true;
+    }
+    if(seen_.size() < store.size())
+    {
+        seen_.resize(store.size(), 0);
+    }
+    bool found = false;
+    std::vector<unsigned int> touched{ source };
+    stack_.assign(1, source);
+    seen_[source] = 1;
+    while(!stack_.empty() && !found)
+    {
+        unsigned int node = stack_.back();
+        stack_.pop_back();
+        for(unsigned int k = 0; k < store.fanoutCaunt(node); ++k)
+        {
+            unsigned int sink = store.fanoutAt(node, k);
+            if(sink == target)
+            {
+                found = true;
+                break;
+            }
+            if(!seen_[sink] && mayReach(sink))
+            {
+                if(covers(sink))
+                {
+                    found = true;
+                    break;
+                }
+                seen_[sink] = 1;
+                touched.push_back(sink);
+                stack_.push_back(sink);
+            }
+        }
+    }
+    for(unsigned int index : touched)
+    {
+        seen_[index] = 0;
+    }
+    return found;
+}
+
+// Labels in topological order for `up`, in reverse for `down`.
+void ReachIndex::rebuild()
+{
+    const NetlistStore& store = doc_.store();
+    std::vector<unsigned int> order = doc_.topoOrder().order();
+    down_.clear();
+    up_.clear();
+    for(unsigned int index : order)
+    {
+        resetGate(slotOf(index));
+    }
+    for(unsigned int index : order)
+    {
+        Label& up = up_[slotOf(index)];
+        for(const unsigned int* it = store.faninBegin(index); it != store.faninEnd(index); ++it)
+        {
+            if(*it != NetlistStore::npos)
+            {
+                up |= up_[slotOf(*it)];
+            }
+        }
+    }
+    for(auto it = order.rbegin(); it != order.rend(); ++it)
+    {
+        Label& down = down_[slotOf(*it)];
+        for(unsigned int k = 0; k < store.fanoutCaunt(*it); ++k)
+        {
+            down |= down_[slotOf(store.fanoutAt(*it, k))];
+        }
+    }
+    numberForest(order);
+    removedEdges_ = 0;
+}
+
+ReachIndex::Label ReachIndex::bitOf(unsigned int slot)
+{
+    return Label(1) << ((slot * 0x9E3779B97F4A7C15ull) >> 58);
+}
+
+unsigned int ReachIndex::slotOf(unsigned int index) const
+{
+    return SlotMap::indexOf(doc_.store().id(index));
+}
+
+// The batch has already been applied to the document, so an edge or a
+// gate may be gone again by now. New gates get their own labels before
+// any edge spreads labels over the final netlist.
+void ReachIndex::apply(const ChangeBatch &batch)
+{
+    for(const Change& change : batch)
+    {
+        if(change.kind == Change::GateAdded && doc_.contains(change.gate))
+        {
+            resetGate(SlotMap::indexOf(change.gate));
+        }
+    }
+    for(const Change& change : batch)
+    {
+        if(change.kind == Change::EdgeRemoved)
+        {
+            ++removedEdges_;
+            unsigned int slot = SlotMap::indexOf(change.gate);
+            if(slot < forest_.size() && forest_[slot].id == change.gate
+               && forest_[slot].parentSlot == SlotMap::indexOf(change.driver))
+            {
+                forestValid_ = false;
+            }
+        }
+        else if(change.kind == Change::EdgeAdded && doc_.contains(change.gate) && doc_.contains(change.driver))
+        {
+            spreadDown(doc_.indexOf(change.driver), doc_.indexOf(change.gate));
+            spreadUp(doc_.indexOf(change.driver), doc_.indexOf(change.gate));
+        }
+    }
+    if(removedEdges_ > doc_.size() / 8 + 1024)
+    {
+        rebuild();
+    }
+}
+
+void ReachIndex::resetGate(unsigned int slot)
+{
+    if(slot >= down_.size())
+    {
+        down_.resize(slot + 1, 0);
+        up_.resize(slot + 1, 0);
+    }
+    down_[slot] = bitOf(slot);
+    up_[slot] = bitOf(slot);
+}
+
+// Pre-order numbers of a depth-first forest over fanout; `last` is the
+// highest number in the subtree of a gate.
+void ReachIndex::numberForest(const std::vector<unsigned int> &order)
+{
+    const NetlistStore& store = doc_.store();
+    forest_.assign(down_.size(), Interval());
+    unsigned int next = 0;
+    // Gate and the next fanout entry to look at.
+    std::vector<std::pair<unsigned int, unsigned int>> stack;
+    for(unsigned int root : order)
+    {
+        if(forest_[slotOf(root)].id != Gate::NoGate)
+        {
+            continue;
+        }
+        Interval& interval = forest_[slotOf(root)];
+        interval.id = store.id(root);
+        interval.first = next++;
+        stack.emplace_back(root, 0);
+        while(!stack.empty())
+        {
+            unsigned int node = stack.back().first;
+            unsigned int& k = stack.back().second;
+            if(k == store.fanoutCaunt(node))
+            {
+                forest_[slotOf(node)].last = next - 1;
+                stack.pop_back();
+                continue;
+            }
+            unsigned int sink = store.fanoutAt(node, k++);
+            Interval& child = forest_[slotOf(sink)];
+            if(child.id == Gate::NoGate)
+            {
+                child.id = store.id(sink);
+                child.parentSlot = slotOf(node);
+                child.first = next++;
+                stack.emplace_back(sink, 0);
+            }
+        }
+    }
+    forestValid_ = true;
+}
+
+// Adds down(sink) to the driver and its fanin cone; a gate that already
+// has those bits has them in its whole fanin cone too.
+void ReachIndex::spreadDown(unsigned int driver, unsigned int sink)
+{
+    const NetlistStore& store = doc_.store();
+    Label bits = down_[slotOf(sink)];
+    stack_.assign(1, driver);
+    while(!stack_.empty())
+    {
+        unsigned int node = stack_.back();
+        stack_.pop_back();
+        Label& down = down_[slotOf(node)];
+        if((down & bits) == bits)
+        {
+            continue;
+        }
+        down |= bits;
+        for(const unsigned int* it = store.faninBegin(node); it != store.faninEnd(node); ++it)
+        {
+            if(*it != NetlistStore::npos)
+            {
+                stack_.push_back(*it);
+            }
+        }
+    }
+}
+
+void ReachIndex::spreadUp(unsigned int driver, unsigned int sink)
+{
+    const NetlistStore& store = doc_.store();
+    Label bits = up_[slotOf(driver)];
+    stack_.assign(1, sink);
+    while(!stack_.empty())
+    {
+        unsigned int node = stack_.back();
+        stack_.pop_back();
+        Label& up = up_[slotOf(node)];
+        if((up & bits) == bits)
+        {
+            continue;
+        }
+        up |= bits;
+        for(unsigned int k = 0; k < store.fanoutCaunt(node); ++k)
+        {
+            stack_.push_back(store.fanoutAt(node, k));
+        }
+    }
+}
+
+} // namespace doc
@@ -0,0 +1,129 @@
+#include "../../inc/Document/slotMap.h"
+
+#include <stdexcept>
+
+namespace doc
+{
+
+
+unsigned int SlotMap::allocate()
+{
+    while(!freeList_.empty())
+    {
+        unsigned int index = freeList_.back();
+        freeList_.pop_back();
+        if(!used_[index])
+        {
+            used_.set(index, 1);
+            ++size_;
+            return makeId(index, generation_[index]);
+        }
+    }
+    unsigned int index = capacity();
+    if(index >= MaxSlots)
+    {
+        throw std::length_error("SlotMap: out of gate slots");
+    }
+    growTo(index + 1);
+    used_.set(index, 1);
+    ++size_;
+    return makeId(index, generation_[index]);
+}
+
+bool SlotMap::allocateAt(unsigned int id)
+{
+    unsigned int index = indexOf(id);
+    if(id == InvalidId || index >= MaxSlots)
+    {
+        return false;
+    }
+    if(index >= capacity())
+    {
+        unsigned int first = capacity();
+        growTo(index + 1);
+        for(unsigned int i = first; i < index; ++i)
+        {
+            freeList_.push_back(i);
+        }
+    }
+    if(used_[index])
+    {
+        return false;
+    }
+    used_.set(index, 1);
+    generation_.set(index, static_cast<unsigned char>(generationOf(id)));
+    ++size_;
+    return true;
+}
+
+void SlotMap::release(unsigned int id)
+{
+    if(!isValid(id))
+    {
+        return;
+    }
+    unsigned int index = indexOf(id);
+    used_.set(index, 0);
+    ++generation_.mut(index);
+    freeList_.push_back(index);
+    --size_;
+}
+
+bool SlotMap::isValid(unsigned int id) const
+{
+    unsigned int index = indexOf(id);
+    return id != InvalidId && index < capacity() && used_[index] && generation_[index] == generationOf(id);
+}
+
+unsigned int SlotMap::idAt(unsigned int index) const
+{
+    if(index >= capacity() || !used_[index])
+    {
+        return InvalidId;
+    }
+    return makeId(index, generation_[index]);
+}
+
+unsigned int SlotMap::capacity() const
+{
+    return used_.size();
+}
+
+unsigned int SlotMap::size() const
+{
+    return size_;
+}
+
+void SlotMap::clear()
+{
+    generation_.clear();
+    used_.clear();
+    freeList_.clear();
+    size_ = 0;
+}
+
+void SlotMap::setArena(const std::shared_ptr<Arena> &arena)
+{
+    generation_.setArena(arena);
+    used_.setArena(arena);
+    freeList_.setArena(arena);
+}
+
+std::size_t SlotMap::bytesApartFrom(const SlotMap &other) const
+{
+    return generation_.bytesApartFrom(other.generation_) + used_.bytesApartFrom(other.used_)
+           + freeList_.bytesApartFrom(other.freeList_);
+}
+
+std::size_t SlotMap::detachedBytes() const
+{
+    return generation_.detachedBytes() + used_.detachedBytes() + freeList_.detachedBytes();
+}
+
+void SlotMap::growTo(unsigned int slots)
+{
+    generation_.resize(slots, 0);
+    used_.resize(slots, 0);
+}
+
+} // namespace doc
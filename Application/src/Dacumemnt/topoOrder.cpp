@@ -0,0 +1,337 @@
+#include "../../inc/Document/topoOrder.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace doc
+{
+
+namespace
+{
+// Labels live in [1, LabelTop); 0 marks a gate that is not in the order.
+constexpr std::uint64_t LabelTop = std::uint64_t(1) << 62;
+constexpr std::uint64_t AppendGap = std::uint64_t(1) << 32;
+// A relabel window of 2^bits labels may hold at most 2^bits / Density^bits gates.
+constexpr double Density = 1.5;
+
+enum Side : unsigned char
+{
+    Unseen = 0,
+    Forward = 1,
+    Backward = 2
+};
+}
+
+
+void TopoOrder::addNode(unsigned int index)
+{
+    if(index >= label_.size())
+    {
+        label_.resize(index + 1, 0);
+        prev_.resize(index + 1, npos);
+        next_.resize(index + 1, npos);
+    }
+    if(label_[index] != 0)
+    {
+        return;
+    }
+    Label last = tail_ == npos ? 0 : label_[tail_];
+    link(index, tail_, npos);
+    if(LabelTop - last > AppendGap)
+    {
+        label_.set(index, last + AppendGap);
+    }
+    else
+    {
+        labelRun(index, index, 1);
+    }
+}
+
+void TopoOrder::removeNode(unsigned int index)
+{
+    if(!contains(index))
+    {
+        return;
+    }
+    unlink(index);
+    label_.set(index, 0);
+}
+
+void TopoOrder::insertEdge(const NetlistStore &store, unsigned int driver, unsigned int sink)
+{
+    if(driver == sink)
+    {
+        throw CycleError("TopoOrder: gate drives itself");
+    }
+    Label upper = label_[driver];
+    Label lower = label_[sink];
+    if(upper < lower)
+    {
+        return;
+    }
+
+    if(marks_.side.size() < label_.size())
+    {
+        marks_.side.resize(label_.size(), Unseen);
+    }
+    std::vector<unsigned char>& side = marks_.side;
+    std::vector<unsigned int> forward;
+    std::vector<unsigned int> backward;
+    std::vector<unsigned int> forwardStack{ sink };
+    std::vector<unsigned int> backwardStack{ driver };
+    side[sink] = Forward;
+    side[driver] = Backward;
+
+    // Forward from the sink over gates before the driver and backward from
+    // the driver over gates after the sink, one gate each in turn. The two
+    // searches meeting means the sink already reaches the driver.
+    while(!forwardStack.empty() && !backwardStack.empty())
+    {
+        unsigned int node = forwardStack.back();
+        forwardStack.pop_back();
+        forward.push_back(node);
+        for(unsigned int k = 0; k < store.fanoutCaunt(node); ++k)
+        {
+            unsigned int next = store.fanoutAt(node, k);
+            if(side[next] == Backward)
+            {
+                clearMarks(forward, backward, forwardStack, backwardStack);
+                throw CycleError("TopoOrder: connection would create a combinational loop");
+            }
+            if(side[next] == Unseen && label_[next] < upper)
+            {
+                side[next] = Forward;
+                forwardStack.push_back(next);
+            }
+        }
+
+        node = backwardStack.back();
+        backwardStack.pop_back();
+        backward.push_back(node);
+        for(const unsigned int* it = store.faninBegin(node); it != store.faninEnd(node); ++it)
+        {
+            if(*it == NetlistStore::npos)
+            {
+                continue;
+            }
+            if(side[*it] == Forward)
+            {
+                clearMarks(forward, backward, forwardStack, backwardStack);
+                throw CycleError("TopoOrder: connection would create a combinational loop");
+            }
+            if(side[*it] == Unseen && label_[*it] > lower)
+            {
+                side[*it] = Backward;
+                backwardStack.push_back(*it);
+            }
+        }
+    }
+
+    // A finished side holds everything it can reach inside the window, so
+    // moving it alone past the other end keeps every edge pointing forward.
+    bool forwardDone = forwardStack.empty();
+    clearMarks(forward, backward, forwardStack, backwardStack);
+    auto byLabel = [this](unsigned int a, unsigned int b) { return label_[a] < label_[b]; };
+    if(forwardDone)
+    {
+        std::sort(forward.begin(), forward.end(), byLabel);
+        moveRun(forward, driver, npos);
+    }
+    else
+    {
+        std::sort(backward.begin(), backward.end(), byLabel);
+        moveRun(backward, npos, sink);
+    }
+}
+
+void TopoOrder::clear()
+{
+    std::shared_ptr<Arena> arena = label_.arena();
+    *this = TopoOrder();
+    setArena(arena);
+}
+
+void TopoOrder::assign(const std::vector<unsigned int> &order)
+{
+    clear();
+    unsigned int slots = 0;
+    for(unsigned int index : order)
+    {
+        slots = std::max(slots, index + 1);
+    }
+    label_.resize(slots, 0);
+    prev_.resize(slots, npos);
+    next_.resize(slots, npos);
+    for(unsigned int index : order)
+    {
+        addNode(index);
+    }
+}
+
+void TopoOrder::setArena(const std::shared_ptr<Arena> &arena)
+{
+    label_.setArena(arena);
+    prev_.setArena(arena);
+    next_.setArena(arena);
+}
+
+std::size_t TopoOrder::bytesApartFrom(const TopoOrder &other) const
+{
+    return label_.bytesApartFrom(other.label_) + prev_.bytesApartFrom(other.prev_) + next_.bytesApartFrom(other.next_);
+}
+
+std::size_t TopoOrder::detachedBytes() const
+{
+    return label_.detachedBytes() + prev_.detachedBytes() + next_.detachedBytes();
+}
+
+bool TopoOrder::contains(unsigned int index) const
+{
+    return index < label_.size() && label_[index] != 0;
+}
+
+bool TopoOrder::precedes(unsigned int a, unsigned int b) const
+{
+    return label_[a] < label_[b];
+}
+
+std::vector<unsigned int> TopoOrder::order() const
+{
+    std::vector<unsigned int> result;
+    result.reserve(caunt_);
+    for(unsigned int node = head_; node != npos; node = next_[node])
+    {
+        result.push_back(node);
+    }
+    return result;
+}
+
+void TopoOrder::link(unsigned int index, unsigned int prev, unsigned int next)
+{
+    prev_.set(index, prev);
+    next_.set(index, next);
+    if(prev == npos)
+    {
+        head_ = index;
+    }
+    else
+    {
+        next_.set(prev, index);
+    }
+    if(next == npos)
+    {
+        tail_ = index;
+    }
+    else
+    {
+        prev_.set(next, index);
+    }
+    ++caunt_;
+}
+
+void TopoOrder::unlink(unsigned int index)
+{
+    unsigned int prev = prev_[index];
+    unsigned int next = next_[index];
+    if(prev == npos)
+    {
+        head_ = next;
+    }
+    else
+    {
+        next_.set(prev, next);
+    }
+    if(next == npos)
+    {
+        tail_ = prev;
+    }
+    else
+    {
+        prev_.set(next, prev);
+    }
+    --caunt_;
+}
+
+// Moves the gates of run, in order, right after `after` or, when that is
+// npos, right before `before`.
+void TopoOrder::moveRun(std::vector<unsigned int> &run, unsigned int after, unsigned int before)
+{
+    for(unsigned int node : run)
+    {
+        unlink(node);
+    }
+    unsigned int prev = after != npos ? after : prev_[before];
+    unsigned int next = after != npos ? next_[after] : before;
+    for(unsigned int node : run)
+    {
+        link(node, prev, next);
+        prev = node;
+    }
+    labelRun(run.front(), run.back(), run.size());
+}
+
+// Gives fresh labels to `caunt` linked gates first..last. If their
+// neighbours leave no room, the smallest aligned label block around
+// them that is sparse enough is spread out evenly.
+void TopoOrder::labelRun(unsigned int first, unsigned int last, unsigned int caunt)
+{
+    Label low = prev_[first] == npos ? 0 : label_[prev_[first]];
+    Label high = next_[last] == npos ? LabelTop : label_[next_[last]];
+    unsigned int left = first;
+    unsigned int right = last;
+    unsigned long long total = caunt;
+    if(high - low <= total)
+    {
+        for(unsigned int bits = 1; bits <= 62; ++bits)
+        {
+            Label size = Label(1) << bits;
+            Label base = low & ~(size - 1);
+            while(prev_[left] != npos && label_[prev_[left]] >= base)
+            {
+                left = prev_[left];
+                ++total;
+            }
+            while(next_[right] != npos && label_[next_[right]] < base + size)
+            {
+                right = next_[right];
+                ++total;
+            }
+            if(static_cast<double>(total) * std::pow(Density, bits) < static_cast<double>(size))
+            {
+                low = base == 0 ? 0 : base - 1;
+                high = base + size;
+                break;
+            }
+        }
+        if(high - low <= total)
+        {
+            throw std::length_error("TopoOrder: out of labels");
+        }
+    }
+
+    Label step = (high - low) / (total + 1);
+    Label label = low;
+    for(unsigned int node = left; ; node = next_[node])
+    {
+        label += step;
+        label_.set(node, label);
+        if(node == right)
+        {
+            break;
+        }
+    }
+}
+
+void TopoOrder::clearMarks(const std::vector<unsigned int> &a, const std::vector<unsigned int> &b,
+                           const std::vector<unsigned int> &c, const std::vector<unsigned int> &d)
+{
+    for(const std::vector<unsigned int>* list : { &a, &b, &c, &d })
+    {
+        for(unsigned int node : *list)
+        {
+            marks_.side[node] = Unseen;
+        }
+    }
+}
+
+} // namespace doc
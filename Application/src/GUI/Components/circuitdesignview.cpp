@@ -31,7 +31,6 @@ CircuitDesignView::CircuitDesignView(QWidget *parent)
     
     // Connect scene changes to the sceneChanged signal
     connect ( m_scene, &QGraphicsScene::changed, this, &CircuitDesignView::sceneChanged );
-    connect ( this, &CircuitDesignView::addGate, MyApplication::instance(), &MyApplication::addGateInDoc );
 }
 
 CustomGraphicsScene *CircuitDesignView::scene() const
@@ -67,10 +66,12 @@ void CircuitDesignView::clearScene ()
 
 void CircuitDesignView::addLogicGate ( const QString &gateType )
 {
-    // Create a scalable graphics item styled as a logic gate
-    //AndGraphicsItem *item = m_scene->addScalableItem();
-    AGraphicsItem *item = m_scene->addScalableItem( gateType );
-    emit addGate( gateType );
+    // The scene creates the item when the document reports the gate
+    unsigned int gateId = MyApplication::instance()->addGateInDoc( gateType );
+    AGraphicsItem *item = m_scene->itemById( gateId );
+    if( item == nullptr ){
+        return;
+    }
     // Position at view center
     QPointF viewCenter = m_view->mapToScene( m_view->viewport()->rect().center() );
     item->setPos( viewCenter );
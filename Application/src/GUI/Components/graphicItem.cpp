@@ -1,5 +1,7 @@
 #include "../../../inc/GUI/Components/graphicItem.h"
 #include "../../../inc/GUI/Components/graphicScen.h"
+#include "../../application.h"
+#include "../../../inc/Editor/editor.h"
 
 #include <QGraphicsSceneMouseEvent>
 #include <QGraphicsSceneMouseEvent>
@@ -19,12 +21,12 @@ namespace gui
 
 AGraphicsItem::AGraphicsItem(QGraphicsItem *parent)
     : QGraphicsItem(parent), 
+      m_gateId(-1),
       m_scale(1.0), 
-      m_isDragging(false),
       m_leftButtonPressed(false),
       m_rightButtonPressed(false)
 {
-    setFlag(QGraphicsItem::ItemIsMovable);
+    // Dragging is the scene's, so that a move is one undo step
     setFlag(QGraphicsItem::ItemIsSelectable);
     setFlag(QGraphicsItem::ItemSendsGeometryChanges);
     setAcceptHoverEvents(true);
@@ -66,8 +68,6 @@ void AGraphicsItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *opt
 void AGraphicsItem::mousePressEvent(QGraphicsSceneMouseEvent *event)
 {
     if (event->button() == Qt::LeftButton) {
-        m_lastMousePos = event->pos();
-        m_isDragging = true;
         m_leftButtonPressed = true;
         emit mouseButtonPressed(LeftButton);
     }
@@ -155,23 +155,9 @@ void AGraphicsItem::handleRightButtonTimeout()
     }
 }
 
-void AGraphicsItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
-{
-    if (m_isDragging) {
-        // Move the item based on mouse movement
-        QPointF delta = event->pos() - m_lastMousePos;
-        moveBy(delta.x(), delta.y());
-        m_lastMousePos = event->pos();
-    }
-    else {
-        QGraphicsItem::mouseMoveEvent(event);
-    }
-}
-
 void AGraphicsItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 {
     if (event->button() == Qt::LeftButton) {
-        m_isDragging = false;
         m_leftButtonPressed = false;
         
         // Send coordinates back
@@ -195,14 +181,18 @@ void AGraphicsItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 void AGraphicsItem::mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event)
 {
     if (event->button() == Qt::LeftButton) {
-        // Emit signal before deletion (optional - so other components can react)
+        edt::Editor& editor = MyApplication::instance()->getEditor();
+        unsigned int gateId = static_cast<unsigned int>(id());
+        if (id() >= 0 && editor.document() && editor.document()->contains(gateId)) {
+            // The scene drops the item once the gate is gone
+            editor.proces(edt::op::RemovGate{ gateId });
+            return;
+        }
+
+        // An item with no gate only lives in the scene
         emit itemDeleted(id());
-        
-        // Delete this item
         scene()->removeItem(this);
         deleteLater();
-        
-        // No need to call base class implementation as we're deleting the item
         return;
     }
     
@@ -247,8 +237,12 @@ void AGraphicsItem::setCustomScale(qreal scale)
 
 qint64 AGraphicsItem::id() const
 {
-    // Convert pointer address to integer for unique ID
-    return reinterpret_cast<qint64>(this);
+    return m_gateId;
+}
+
+void AGraphicsItem::setId(qint64 gateId)
+{
+    m_gateId = gateId;
 }
 
 
@@ -1,6 +1,7 @@
 // graphicScen.cpp
 #include "../../../inc/GUI/Components/graphicScen.h"
 #include "../../application.h"
+#include "../../../inc/Editor/editor.h"
 #include <QPainter>
 
 namespace gui {
@@ -88,6 +89,10 @@ CustomGraphicsScene::CustomGraphicsScene(QObject *parent)
     
     // Connect to selection changed signal to handle all types of selection
     connect(this, &QGraphicsScene::selectionChanged, this, &CustomGraphicsScene::handleSelectionChanged);
+
+    m_dragFrameTimer.setSingleShot(true);
+    m_dragFrameTimer.setInterval(DRAG_FRAME_MS);
+    connect(&m_dragFrameTimer, &QTimer::timeout, this, &CustomGraphicsScene::showDragFrame);
 }
 
 QList<AGraphicsItem*> CustomGraphicsScene::selectedScalableItems() const
@@ -124,6 +129,15 @@ void CustomGraphicsScene::clearScene()
     }
     
     // Clear internal state
+    m_dragFrameTimer.stop();
+    m_dragging = false;
+    m_dragIds.clear();
+    m_dragUnbound.clear();
+    m_itemsBySlot.clear();
+    m_edgeLines.clear();
+    m_committingLine = nullptr;
+    m_removedPos.clear();
+    m_removedOrder.clear();
     m_rightButtonDown = false;
     m_currentLine = nullptr;
     m_sourceItem = nullptr;
@@ -159,7 +173,7 @@ ConnectionLine* CustomGraphicsScene::addConnectionLine(const QPointF& startPos,
     }
     
     // Finalize the creation of the line
-    line->finishCreation();
+    commitLine(line);
     
     return line;
 }
@@ -180,15 +194,64 @@ AGraphicsItem* CustomGraphicsScene::addScalableItemAtPosition(const QString& gat
     return item;
 }
 
+void CustomGraphicsScene::bindItem(AGraphicsItem* item, qint64 gateId)
+{
+    unsigned int slot = doc::SlotMap::indexOf(static_cast<unsigned int>(gateId));
+    if (slot >= m_itemsBySlot.size()) {
+        m_itemsBySlot.resize(slot + 1, nullptr);
+    }
+    item->setId(gateId);
+    m_itemsBySlot[slot] = item;
+    connect(item, &AGraphicsItem::itemDeleted, this, &CustomGraphicsScene::unbindItem);
+}
+
+AGraphicsItem* CustomGraphicsScene::itemById(qint64 gateId) const
+{
+    unsigned int slot = doc::SlotMap::indexOf(static_cast<unsigned int>(gateId));
+    if (gateId < 0 || slot >= m_itemsBySlot.size()) {
+        return nullptr;
+    }
+    // A stale id (older generation) does not match the item in the slot
+    AGraphicsItem* item = m_itemsBySlot[slot];
+    return item && item->id() == gateId ? item : nullptr;
+}
+
+void CustomGraphicsScene::moveItems(const std::vector<qint64>& gateIds, const std::vector<QPointer<AGraphicsItem>>& unbound, const QPointF& delta)
+{
+    for (qint64 gateId : gateIds) {
+        AGraphicsItem* item = itemById(gateId);
+        if (item) {
+            item->moveBy(delta.x(), delta.y());
+        }
+    }
+    for (AGraphicsItem* item : unbound) {
+        if (item) {
+            item->moveBy(delta.x(), delta.y());
+        }
+    }
+    // The rects follow their items; rebuilding them is for selection changes
+    for (SelectionRect* rect : m_selectionRects) {
+        rect->updatePosition();
+    }
+}
+
+void CustomGraphicsScene::unbindItem(qint64 gateId)
+{
+    unsigned int slot = doc::SlotMap::indexOf(static_cast<unsigned int>(gateId));
+    if (slot < m_itemsBySlot.size() && m_itemsBySlot[slot] && m_itemsBySlot[slot]->id() == gateId) {
+        m_itemsBySlot[slot] = nullptr;
+    }
+}
+
 AGraphicsItem* CustomGraphicsScene::addScalableItem(const QString &gateType)
 {
-    auto findResult = gateMap.find(gateType.toStdString());
+    const doc::GateDescriptor* desc = doc::findGateDescriptor(gateType.toStdString());
     AGraphicsItem *item;
     
-    if (findResult == gateMap.end()) {
+    if (desc == nullptr) {
         item = new AGraphicsItem();
     } else {
-        item = findResult->second->clone();
+        item = gateMap[static_cast<unsigned int>(desc->type)]->clone();
     }
 
     addItem(item);
@@ -213,6 +276,112 @@ void CustomGraphicsScene::scaleDownSelected()
     updateSelectionRects();
 }
 
+void CustomGraphicsScene::applyChanges(const doc::ChangeBatch& changes)
+{
+    bool removed = false;
+    for (const doc::Change& change : changes) {
+        switch (change.kind) {
+        case doc::Change::GateAdded:
+            showGate(change);
+            break;
+        case doc::Change::GateRemoved:
+            hideGate(change);
+            removed = true;
+            break;
+        case doc::Change::EdgeAdded:
+            showEdge(change);
+            break;
+        case doc::Change::EdgeRemoved:
+            hideEdge(change);
+            removed = true;
+            break;
+        default:
+            break;
+        }
+    }
+    if (removed) {
+        updateSelectionRects();
+    }
+}
+
+// A gate that comes back (redo, undo of a removal) gets its old place.
+void CustomGraphicsScene::showGate(const doc::Change& change)
+{
+    if (itemById(change.gate)) {
+        return;
+    }
+    AGraphicsItem* item = addScalableItem(QString::fromLatin1(doc::descriptor(change.type).name));
+    bindItem(item, change.gate);
+    auto pos = m_removedPos.find(change.gate);
+    if (pos != m_removedPos.end()) {
+        item->setPos(pos->second);
+        m_removedPos.erase(pos);
+    }
+}
+
+void CustomGraphicsScene::hideGate(const doc::Change& change)
+{
+    AGraphicsItem* item = itemById(change.gate);
+    if (!item) {
+        return;
+    }
+    if (m_removedOrder.size() == REMOVED_POS_CAP) {
+        m_removedPos.erase(m_removedOrder.front());
+        m_removedOrder.pop_front();
+    }
+    m_removedPos[change.gate] = item->pos();
+    m_removedOrder.push_back(change.gate);
+    unbindItem(change.gate);
+    removeItem(item);
+    item->deleteLater();
+}
+
+// The edge takes over the line drawn for it, if any, else gets a new one.
+void CustomGraphicsScene::showEdge(const doc::Change& change)
+{
+    AGraphicsItem* driver = itemById(change.driver);
+    AGraphicsItem* sink = itemById(change.gate);
+    if (!driver || !sink) {
+        return;
+    }
+    ConnectionLine* line = m_committingLine;
+    if (line && line->sourceItem() == driver && line->targetItem() == sink) {
+        m_committingLine = nullptr;
+    }
+    else {
+        line = new ConnectionLine();
+        line->setLine(QLineF(driver->sceneBoundingRect().center(), sink->sceneBoundingRect().center()));
+        line->setSourceItem(driver);
+        line->setTargetItem(sink);
+        addItem(line);
+    }
+    m_edgeLines[{ change.gate, change.port }] = line;
+}
+
+void CustomGraphicsScene::hideEdge(const doc::Change& change)
+{
+    auto edge = m_edgeLines.find({ change.gate, change.port });
+    if (edge == m_edgeLines.end()) {
+        return;
+    }
+    // The user may have deleted the line already
+    ConnectionLine* line = edge->second;
+    if (line) {
+        if (line->scene() == this) {
+            removeItem(line);
+        }
+        line->deleteLater();
+    }
+    m_edgeLines.erase(edge);
+}
+
+void CustomGraphicsScene::commitLine(ConnectionLine* line)
+{
+    m_committingLine = line;
+    line->finishCreation();
+    m_committingLine = nullptr;
+}
+
 void CustomGraphicsScene::handleSelectionChanged()
 {
     // Get all selected items
@@ -269,6 +438,11 @@ void CustomGraphicsScene::mousePressEvent(QGraphicsSceneMouseEvent *event)
     if (event->button() == Qt::LeftButton) {
         // Let QGraphicsScene handle selection through rubber band
         QGraphicsScene::mousePressEvent(event);
+
+        AGraphicsItem* item = itemAtPosition(event->scenePos());
+        if (item) {
+            beginDrag(item, event->scenePos());
+        }
     }
     else if (event->button() == Qt::RightButton) {
         // Start drawing a line
@@ -303,19 +477,27 @@ void CustomGraphicsScene::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
                                event->scenePos().x(), event->scenePos().y());
         event->accept();
     }
+    else if (m_dragging && (event->buttons() & Qt::LeftButton)) {
+        // Only the target moves here; showDragFrame() catches up
+        m_dragTarget = event->scenePos() - m_dragStart;
+        if (!m_dragFrameTimer.isActive()) {
+            m_dragFrameTimer.start();
+        }
+        event->accept();
+    }
     else {
         QGraphicsScene::mouseMoveEvent(event);
-        
-        // Update selection rectangles if items are being moved
-        if (!selectedItems().isEmpty()) {
-            updateSelectionRects();
-        }
     }
 }
 
 void CustomGraphicsScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 {
     if (event->button() == Qt::LeftButton) {
+        if (m_dragging) {
+            m_dragTarget = event->scenePos() - m_dragStart;
+            endDrag();
+        }
+
         // Let QGraphicsScene handle selection completion
         QGraphicsScene::mouseReleaseEvent(event);
         
@@ -346,7 +528,7 @@ void CustomGraphicsScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
         }
         
         // Finalize the creation of the line
-        m_currentLine->finishCreation();
+        commitLine(m_currentLine);
         
         // Reset tracking variables
         m_sourceItem = nullptr;
@@ -367,37 +549,127 @@ void CustomGraphicsScene::wheelEvent(QGraphicsSceneWheelEvent *event)
 
 void CustomGraphicsScene::initGateMap()
 {
-    gateMap.emplace("AND_2",  new AndGraphicsItem());
-    gateMap.emplace("AND_3",  new And3GraphicsItem());
-    gateMap.emplace("AND_4",  new And4GraphicsItem());
-    gateMap.emplace("OR_2",   new OrGraphicsItem());
-    gateMap.emplace("OR_3",   new Or3GraphicsItem());
-    gateMap.emplace("OR_4",   new Or4GraphicsItem());
-    gateMap.emplace("NAND_2", new NandGraphicsItem());
-    gateMap.emplace("NAND_3", new Nand3GraphicsItem());
-    gateMap.emplace("NAND_4", new Nand4GraphicsItem());
-    gateMap.emplace("NOR_2",  new NorGraphicsItem());
-    gateMap.emplace("NOR_3",  new Nor3GraphicsItem());
-    gateMap.emplace("NOR_4",  new Nor4GraphicsItem());
-    gateMap.emplace("NOT",  new NotGraphicsItem());
-    gateMap.emplace("XOR_2",  new XorGraphicsItem());
-    gateMap.emplace("XOR_3",  new Xor3GraphicsItem());
-    gateMap.emplace("XOR_4",  new Xor4GraphicsItem());
-    gateMap.emplace("XNOR_2", new XnorGraphicsItem());
-    gateMap.emplace("XNOR_3", new Xnor3GraphicsItem());
-    gateMap.emplace("XNOR_4", new Xnor4GraphicsItem());
-    gateMap.emplace("INPUT",  new InputGraphicIthem());
-    gateMap.emplace("OUTPUT", new OutputGraphicIthem());
-    gateMap.emplace("MUX_2",  new Mux2GraphicIthem());
-    gateMap.emplace("MUX_4",  new Mux4GraphicIthem());
-    gateMap.emplace("HALF_ADDER",  new HalfAdderGraphicIthem());
-    gateMap.emplace("FULL_ADDER",  new FullAdderGraphicIthem());
+    auto set = [this](doc::GateType type, AGraphicsItem* prototype) {
+        gateMap[static_cast<unsigned int>(type)] = prototype;
+    };
+    set(doc::GateType::AND_2,      new AndGraphicsItem());
+    set(doc::GateType::AND_3,      new And3GraphicsItem());
+    set(doc::GateType::AND_4,      new And4GraphicsItem());
+    set(doc::GateType::OR_2,       new OrGraphicsItem());
+    set(doc::GateType::OR_3,       new Or3GraphicsItem());
+    set(doc::GateType::OR_4,       new Or4GraphicsItem());
+    set(doc::GateType::NAND_2,     new NandGraphicsItem());
+    set(doc::GateType::NAND_3,     new Nand3GraphicsItem());
+    set(doc::GateType::NAND_4,     new Nand4GraphicsItem());
+    set(doc::GateType::NOR_2,      new NorGraphicsItem());
+    set(doc::GateType::NOR_3,      new Nor3GraphicsItem());
+    set(doc::GateType::NOR_4,      new Nor4GraphicsItem());
+    set(doc::GateType::NOT,        new NotGraphicsItem());
+    set(doc::GateType::XOR_2,      new XorGraphicsItem());
+    set(doc::GateType::XOR_3,      new Xor3GraphicsItem());
+    set(doc::GateType::XOR_4,      new Xor4GraphicsItem());
+    set(doc::GateType::XNOR_2,     new XnorGraphicsItem());
+    set(doc::GateType::XNOR_3,     new Xnor3GraphicsItem());
+    set(doc::GateType::XNOR_4,     new Xnor4GraphicsItem());
+    set(doc::GateType::INPUT,      new InputGraphicIthem());
+    set(doc::GateType::OUTPUT,     new OutputGraphicIthem());
+    set(doc::GateType::MUX_2,      new Mux2GraphicIthem());
+    set(doc::GateType::MUX_4,      new Mux4GraphicIthem());
+    set(doc::GateType::HALF_ADDER, new HalfAdderGraphicIthem());
+    set(doc::GateType::FULL_ADDER, new FullAdderGraphicIthem());
 }
 
+// Looks through the selection rects and lines drawn over the items.
 AGraphicsItem* CustomGraphicsScene::itemAtPosition(const QPointF& pos)
 {
-    QGraphicsItem* item = itemAt(pos, QTransform());
-    return qgraphicsitem_cast<AGraphicsItem*>(item);
+    for (QGraphicsItem* item : items(pos)) {
+        AGraphicsItem* scalableItem = qgraphicsitem_cast<AGraphicsItem*>(item);
+        if (scalableItem) {
+            return scalableItem;
+        }
+    }
+    return nullptr;
+}
+
+// Pressing a selected item drags the selection, any other item drags alone.
+void CustomGraphicsScene::beginDrag(AGraphicsItem* item, const QPointF& scenePos)
+{
+    m_dragIds.clear();
+    m_dragUnbound.clear();
+    QList<AGraphicsItem*> dragged;
+    if (item->isSelected()) {
+        dragged = selectedScalableItems();
+    }
+    else {
+        dragged.append(item);
+    }
+    for (AGraphicsItem* draggedItem : dragged) {
+        if (draggedItem->id() < 0) {
+            m_dragUnbound.push_back(draggedItem);
+        }
+        else {
+            m_dragIds.push_back(draggedItem->id());
+        }
+    }
+    m_dragging = true;
+    m_dragStart = scenePos;
+    m_dragTarget = QPointF();
+    m_dragShown = QPointF();
+}
+
+void CustomGraphicsScene::showDragFrame()
+{
+    QPointF delta = m_dragTarget - m_dragShown;
+    if (delta.isNull()) {
+        return;
+    }
+    moveItems(m_dragIds, m_dragUnbound, delta);
+    m_dragShown = m_dragTarget;
+}
+
+// The items are where the drag left them; the editor only records it.
+void CustomGraphicsScene::endDrag()
+{
+    m_dragFrameTimer.stop();
+    showDragFrame();
+    m_dragging = false;
+    if (!m_dragShown.isNull()) {
+        MyApplication::instance()->getEditor().procesDone(std::make_shared<MoveItems>(this, std::move(m_dragIds), std::move(m_dragUnbound), m_dragShown));
+    }
+    m_dragIds.clear();
+    m_dragUnbound.clear();
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////////
+///Move items action
+/////////////////////////////////////////////////////////////////////////////////
+MoveItems::MoveItems(CustomGraphicsScene* scene, std::vector<qint64> gateIds, std::vector<QPointer<AGraphicsItem>> unbound, const QPointF& delta)
+    : m_scene(scene),
+      m_gateIds(std::move(gateIds)),
+      m_unbound(std::move(unbound)),
+      m_delta(delta)
+{
+}
+
+void MoveItems::doo()
+{
+    // The scene may be gone while the history still holds the move
+    if (m_scene) {
+        m_scene->moveItems(m_gateIds, m_unbound, m_delta);
+    }
+}
+
+std::shared_ptr<edt::IAction> MoveItems::returnInversAction()
+{
+    return std::make_shared<MoveItems>(m_scene.data(), m_gateIds, m_unbound, -m_delta);
+}
+
+std::size_t MoveItems::byteSize() const
+{
+    return sizeof(MoveItems) + 2 * sizeof(void*) + m_gateIds.capacity() * sizeof(qint64)
+           + m_unbound.capacity() * sizeof(QPointer<AGraphicsItem>);
 }
 
 }//namespace gui
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "../../inc/GUI/mainWindow.h"
 #include <QMenuBar>
 #include <QMenu>
+#include <QStatusBar>
 #include <QDebug>
 #include "mainWindow.h"
 #include "../application.h"
@@ -27,6 +28,7 @@ void MainWindow::initComponents()
     addProject = new AddProjectToolBar(this);
     zoom = new ZoomToolBar(this);
     circuitView = new CircuitDesignView(this);
+    historyLabel = new QLabel(this);
 }
 
 
@@ -38,6 +40,8 @@ void MainWindow::addComponents()
     addToolBar(Qt::TopToolBarArea, zoom);
     menuBar()->addMenu(fileMenu);
     setCentralWidget(circuitView);
+    statusBar()->addPermanentWidget(historyLabel);
+    updateHistoryStatus();
 }
 
 
@@ -58,9 +62,10 @@ void MainWindow::connectSignals()
     connect( circuitView, &CircuitDesignView::sceneChanged, 
             this, &MainWindow::updateUndoRedoActions);
 
-    connect( this, &MainWindow::addGate, MyApplication::instance(), &MyApplication::addGateInDoc );
     connect( this, &MainWindow::addConnect, MyApplication::instance(), &MyApplication::addConnect );
     connect( MyApplication::instance(), &MyApplication::SignaLLineAndGraphicSchenBridg, this, &MainWindow::conectFiltr );
+    connect( MyApplication::instance(), &MyApplication::documentChanged, circuitView->scene(), &CustomGraphicsScene::applyChanges );
+    connect( MyApplication::instance(), &MyApplication::documentChanged, this, &MainWindow::updateHistoryStatus );
     
     // Connect undo/redo toolbar to QUndoStack (assuming it has one)
     // This would depend on your UndoRedoToolBar implementation
@@ -107,7 +112,6 @@ void MainWindow::zoomH( const QString &eventName )
 void MainWindow::addLogicGate( const QString &gateType )
 {
     circuitView->addLogicGate( gateType );
-    emit addGate( gateType );
 
 }
 
@@ -135,6 +139,13 @@ void MainWindow::updateUndoRedoActions()
     // This would depend on your UndoRedoToolBar implementation
     // undoRedoToolBar->setUndoEnabled(undoStack->canUndo());
     // undoRedoToolBar->setRedoEnabled(undoStack->canRedo());
+    updateHistoryStatus();
+}
+
+void MainWindow::updateHistoryStatus()
+{
+    const edt::Editor& editor = MyApplication::instance()->getEditor();
+    historyLabel->setText( tr("History %1 / %2 KiB").arg( editor.historyBytes() / 1024 ).arg( editor.historyBudget() / 1024 ) );
 }
 
 
@@ -2,15 +2,27 @@
 #include <QPalette>
 #include <QStyleFactory>
 #include <QGraphicsView>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
 
 
 #include <iostream>
 #include "application.h"
 #include "../inc/Editor/editor.h"
+#include "../inc/Sterializers/Sterializer.h"
 
 MyApplication::MyApplication(int &argc, char **argv) : QApplication(argc, argv)
 {
-    doc_ = std::make_shared<doc::Document>();
+    std::shared_ptr<doc::Document> recovered = openAutosaveSession();
+    if( recovered ){
+        std::cout<<"recovered unsaved session := "<<recovered->size()<<" gates"<<std::endl;
+    }
+    attachDocument( recovered ? recovered : std::make_shared<doc::Document>() );
+    autosaveTimer_.setInterval( 1000 );
+    connect( &autosaveTimer_, &QTimer::timeout, this, &MyApplication::autosave );
+    autosaveTimer_.start();
     initBackgroundPattern(); // initialize pattern on start
     this->setStyle(QStyleFactory::create("Fusion"));
     this->setStyleSheet(R"(
@@ -22,6 +34,14 @@ MyApplication::MyApplication(int &argc, char **argv) : QApplication(argc, argv)
     
 }
 
+MyApplication::~MyApplication()
+{
+    editLog_.reset();
+    EditLog::discard( autosaveDir_ );
+    QDir().rmdir( QString::fromStdString( autosaveDir_ ) );
+    autosaveLock_.reset();
+}
+
 MyApplication *MyApplication::instance()
 {
     return static_cast<MyApplication*>(QApplication::instance());
@@ -32,41 +52,75 @@ std::shared_ptr<doc::Document> MyApplication::getDocument()
     return doc_;
 }
 
+edt::Editor &MyApplication::getEditor()
+{
+    return *editor_;
+}
+
 void MyApplication::saveJsonFile(const QString &path)
 {
     std::cout<<path.toStdString()<<std::endl;
+    if( path.toStdString() == savedPath_ && fingerprint_->design() == savedFingerprint_ ){
+        std::cout<<"save: unchanged since last save"<<std::endl;
+        return;
+    }
+    Sterializer sterializer;
+    sterializer.save( path.toStdString(), doc_ );
+    savedPath_ = path.toStdString();
+    savedFingerprint_ = fingerprint_->design();
 }
 
 void MyApplication::newDocument(const QString& mesig)
 {
     std::cout<<"new action mesig := "<<mesig.toStdString()<<std::endl;    
-    doc_ = std::make_shared<doc::Document>();
+    attachDocument( std::make_shared<doc::Document>() );
 }
 
 void MyApplication::addProjectJsonFile(const QString &path)
 {
     std::cout<<path.toStdString()<<std::endl;
+    std::shared_ptr<const doc::Module> module;
+    auto it = modules_.find( path.toStdString() );
+    if( it != modules_.end() ){
+        module = it->second;
+    }else{
+        try{
+            Sterializer sterializer;
+            std::shared_ptr<doc::Document> project = sterializer.open( path.toStdString() );
+            module = std::make_shared<const doc::Module>( QFileInfo( path ).baseName().toStdString(), project->snapshot(), path.toStdString() );
+        }catch( const std::exception& error ){
+            std::cout<<"add project: "<<error.what()<<std::endl;
+            return;
+        }
+        modules_[ path.toStdString() ] = module;
+    }
+
+    doc::Instance instance;
+    instance.module = module;
+    editor_->proces( std::make_shared<edt::AddInstance>( doc_, instance ) );
+    std::cout<<"instance of "<<module->name()<<" := "<<module->flatGateCaunt()<<" gates"<<std::endl;
 }
 
 void MyApplication::editorControl(const QString &actionName)
 {
-    edt::Editor& editor = edt::Editor::getEditor();
     if( actionName.toStdString() == "redo" ){
-        editor.redo();
+        editor_->redo();
         return;
     }
-    editor.undo();
+    editor_->undo();
 }
 
-void MyApplication::addGateInDoc(const QString &gateType)
+void MyApplication::historyJump(int position)
 {
-    edt::Editor &edtInstance = edt::Editor::getEditor();
-    std::shared_ptr<doc::Gate> gatePtr = std::make_shared<doc::Gate>();
-    gatePtr->setType(gateType.toStdString());
-    std::shared_ptr<edt::AddGate> addGateAction= std::make_shared<edt::AddGate>(doc_, gatePtr);
-    edtInstance.proces(addGateAction);
+    editor_->jumpTo( position < 0 ? 0 : static_cast<std::size_t>( position ) );
+}
+
+unsigned int MyApplication::addGateInDoc(const QString &gateType)
+{
+    unsigned int gateId = editor_->proces( edt::op::AddGate( doc::gateTypeFromName( gateType.toStdString() ) ) );
     std::cout<<"gate for add in doc := "<<gateType.toStdString()<<std::endl;
-    std::cout<<"dock size := "<<doc_->getGateCaunt()<<std::endl;
+    std::cout<<"dock size := "<<doc_->size()<<std::endl;
+    return gateId;
 }
 
 void MyApplication::lineAndGraphicSchenBridg(const QPointF &sourcePoint, const QPointF &targetPoint)
@@ -76,15 +130,155 @@ void MyApplication::lineAndGraphicSchenBridg(const QPointF &sourcePoint, const Q
 
 void MyApplication::addConnect( gui::AGraphicsItem *ithemC, gui::AGraphicsItem *ithemI)
 {
-    std::cout<<"addConnect\n";
-
+    unsigned int driverId = static_cast<unsigned int>( ithemC->id() );
+    unsigned int sinkId = static_cast<unsigned int>( ithemI->id() );
+    if( !doc_->contains( driverId ) || !doc_->contains( sinkId ) ){
+        return;
+    }
+    // Wire to the first open input of the sink
+    unsigned int inputCaunt = doc::descriptor( doc_->typeOf( sinkId ) ).inputCaunt;
+    unsigned int port = 0;
+    while( port < inputCaunt && doc_->driverOf( port, sinkId ) != doc::Gate::NoGate ){
+        ++port;
+    }
+    if( port == inputCaunt ){
+        std::cout<<"addConnect: no free input"<<std::endl;
+        return;
+    }
+    try{
+        editor_->proces( edt::op::AddEdge{ driverId, port, sinkId } );
+    }catch( const doc::CycleError& error ){
+        std::cout<<"addConnect: "<<error.what()<<std::endl;
+    }
 }
 
 void MyApplication::openJsonFile(const QString &path)
 {
     std::cout<<path.toStdString()<<std::endl;
+    std::shared_ptr<doc::Arena> arena;
+    if( QFileInfo( path ).size() > LargeDesignBytes ){
+        arena = largeDesignArena();
+    }
+    std::shared_ptr<doc::Document> doc;
+    try{
+        Sterializer sterializer;
+        doc = sterializer.open( path.toStdString(), arena );
+    }catch( const std::exception& error ){
+        std::cout<<"open: "<<error.what()<<std::endl;
+        return;
+    }
+    attachDocument( doc );
+    savedPath_ = path.toStdString();
+    savedFingerprint_ = fingerprint_->design();
+}
+
+// The scratch file is swap space only: it is unlinked as soon as it is
+// created and holds nothing a later run could read back.
+std::shared_ptr<doc::Arena> MyApplication::largeDesignArena()
+{
+    QString path = QStandardPaths::writableLocation( QStandardPaths::TempLocation )
+                   + QString( "/logicsintes-%1-%2.arena" ).arg( applicationPid() ).arg( QDateTime::currentMSecsSinceEpoch() );
+    try{
+        return doc::Arena::mapped( path.toStdString() );
+    }catch( const std::exception& error ){
+        std::cout<<"open: "<<error.what()<<", loading into memory"<<std::endl;
+        return nullptr;
+    }
+}
+
+
+void MyApplication::attachDocument(std::shared_ptr<doc::Document> doc)
+{
+    if( doc_ ){
+        doc_->journal().unsubscribe( journalHandle_ );
+    }
+    editLog_.reset();
+    fingerprint_.reset();
+    savedPath_.clear();
+    // The history of the old document goes with it.
+    editor_.reset();
+    doc_ = doc;
+    editor_ = std::make_unique<edt::Editor>( doc_ );
+    editor_->setHistoryBudget( HistoryBudget );
+    fingerprint_ = std::make_unique<doc::Fingerprint>( *doc_ );
+    journalHandle_ = doc_->journal().subscribe( [this]( const doc::ChangeBatch& changes ){
+        emit documentChanged( changes );
+    });
+    try{
+        editLog_ = std::make_unique<EditLog>( autosaveDir_, *doc_, []( const std::string& path, const doc::Netlist& netlist, unsigned int gateCaunt ){
+            Sterializer sterializer;
+            sterializer.save( path, netlist, gateCaunt );
+        }, [this]( const std::string& ){
+            // The log cannot go while it publishes; autosave() reports
+            // the error and drops it.
+            QTimer::singleShot( 0, this, &MyApplication::autosave );
+        });
+    }catch( const std::exception& error ){
+        std::cout<<"autosave: "<<error.what()<<std::endl;
+    }
+}
+
+// Every instance logs into a session directory of its own, held by a
+// lock file next to it. A lock whose process is gone is stale and
+// tryLock() takes it: that session was left by a crash. The newest such
+// session with something in it is recovered and taken over; one that
+// fails to load is kept for a later start.
+std::shared_ptr<doc::Document> MyApplication::openAutosaveSession()
+{
+    QDir root( QStandardPaths::writableLocation( QStandardPaths::AppDataLocation ) + "/autosave" );
+    root.mkpath( "." );
+    const QStringList sessions = root.entryList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Time );
+    for( const QString& session : sessions ){
+        auto lock = std::make_unique<QLockFile>( root.filePath( session + ".lock" ) );
+        lock->setStaleLockTime( 0 );
+        if( !lock->tryLock( 0 ) ){
+            continue;
+        }
+        std::string directory = root.filePath( session ).toStdString();
+        std::shared_ptr<doc::Document> recovered;
+        try{
+            recovered = EditLog::recover( directory, []( const std::string& path ){
+                Sterializer sterializer;
+                return sterializer.open( path );
+            });
+        }catch( const std::exception& error ){
+            std::cout<<"recover: "<<error.what()<<std::endl;
+            continue;
+        }
+        if( recovered ){
+            autosaveDir_ = directory;
+            autosaveLock_ = std::move( lock );
+            return recovered;
+        }
+        EditLog::discard( directory );
+        root.rmdir( session );
+    }
+    QString session = QString::number( QCoreApplication::applicationPid() ) + "-"
+                      + QString::number( QDateTime::currentMSecsSinceEpoch() );
+    autosaveLock_ = std::make_unique<QLockFile>( root.filePath( session + ".lock" ) );
+    autosaveLock_->setStaleLockTime( 0 );
+    if( !autosaveLock_->tryLock( 0 ) ){
+        std::cout<<"autosave: cannot lock session "<<session.toStdString()<<std::endl;
+    }
+    root.mkpath( session );
+    autosaveDir_ = root.filePath( session ).toStdString();
+    return nullptr;
 }
 
+void MyApplication::autosave()
+{
+    if( !editLog_ ){
+        return;
+    }
+    try{
+        editLog_->flush();
+        editLog_->compactIfLarge();
+    }catch( const std::exception& error ){
+        // The log is left as far as it got; recovery replays up to there.
+        std::cout<<"autosave stopped: "<<error.what()<<std::endl;
+        editLog_.reset();
+    }
+}
 
 void MyApplication::initBackgroundPattern() {
     QPixmap dotPattern(50, 50);
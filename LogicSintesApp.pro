@@ -36,11 +36,29 @@ SOURCES += \
     Application/src/GUI/Components/connectLine.cpp \
     Application/src/GUI/Components/graphicItem.cpp \
     Application/src/GUI/Components/graphicScen.cpp \
+    Application/inc/Comand/comand.cpp \
+    Application/inc/Comand/factory.cpp \
     Application/inc/Editor/action.cpp \
+    Application/inc/Editor/edit.cpp \
     Application/inc/Editor/editor.cpp \
+    Application/inc/Editor/moduleExtraction.cpp \
+    Application/inc/Editor/packedHistory.cpp \
     Application/inc/Sterializers/Sterializer.cpp \
+    Application/inc/Sterializers/editLog.cpp \
+    Application/src/Dacumemnt/arena.cpp \
+    Application/src/Dacumemnt/changeJournal.cpp \
     Application/src/Dacumemnt/document.cpp \
-    Application/src/Dacumemnt/gets.cpp 
+    Application/src/Dacumemnt/documentBuilder.cpp \
+    Application/src/Dacumemnt/fingerprint.cpp \
+    Application/src/Dacumemnt/gateOrder.cpp \
+    Application/src/Dacumemnt/gets.cpp \
+    Application/src/Dacumemnt/gateType.cpp \
+    Application/src/Dacumemnt/module.cpp \
+    Application/src/Dacumemnt/netlist.cpp \
+    Application/src/Dacumemnt/netlistStore.cpp \
+    Application/src/Dacumemnt/reachIndex.cpp \
+    Application/src/Dacumemnt/slotMap.cpp \
+    Application/src/Dacumemnt/topoOrder.cpp
 
 # Header files
 HEADERS += \
@@ -54,11 +72,32 @@ HEADERS += \
     Application/inc/GUI/Components/connectLine.h \
     Application/inc/GUI/Components/graphicItem.h \
     Application/inc/GUI/Components/graphicScen.h \
+    Application/inc/Comand/comand.h \
+    Application/inc/Comand/factory.h \
+    Application/inc/Document/arena.h \
+    Application/inc/Document/changeJournal.h \
+    Application/inc/Document/cowVector.h \
     Application/inc/Document/document.h \
+    Application/inc/Document/documentBuilder.h \
+    Application/inc/Document/fingerprint.h \
+    Application/inc/Document/gateOrder.h \
     Application/inc/Document/gets.h \
+    Application/inc/Document/gateType.h \
+    Application/inc/Document/module.h \
+    Application/inc/Document/netlist.h \
+    Application/inc/Document/netlistStore.h \
+    Application/inc/Document/reachIndex.h \
+    Application/inc/Document/smallVector.h \
+    Application/inc/Document/slotMap.h \
+    Application/inc/Document/topoOrder.h \
     Application/inc/Editor/action.h \
+    Application/inc/Editor/edit.h \
     Application/inc/Editor/editor.h \
-    Application/inc/Sterializers/Sterializer.h
+    Application/inc/Editor/moduleExtraction.h \
+    Application/inc/Editor/packedHistory.h \
+    Application/inc/Editor/ring.h \
+    Application/inc/Sterializers/Sterializer.h \
+    Application/inc/Sterializers/editLog.h
 
 # Resources
 RESOURCES += \
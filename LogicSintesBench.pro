@@ -0,0 +1,53 @@
+# Traversal benchmark for Document::renumber; see Application/bench/renumberBench.cpp.
+# Build and run: qmake LogicSintesBench.pro && make && ./LogicSintesBench [comands] [seed]
+QT -= core gui
+
+TARGET = LogicSintesBench
+TEMPLATE = app
+CONFIG += c++17 console release
+CONFIG -= app_bundle
+
+QMAKE_CXXFLAGS += -O2
+
+INCLUDEPATH += Application/inc
+
+# Source files
+SOURCES += \
+    Application/bench/renumberBench.cpp \
+    Application/inc/Comand/comand.cpp \
+    Application/inc/Comand/factory.cpp \
+    Application/src/Dacumemnt/arena.cpp \
+    Application/src/Dacumemnt/changeJournal.cpp \
+    Application/src/Dacumemnt/document.cpp \
+    Application/src/Dacumemnt/documentBuilder.cpp \
+    Application/src/Dacumemnt/fingerprint.cpp \
+    Application/src/Dacumemnt/gateOrder.cpp \
+    Application/src/Dacumemnt/gets.cpp \
+    Application/src/Dacumemnt/gateType.cpp \
+    Application/src/Dacumemnt/module.cpp \
+    Application/src/Dacumemnt/netlist.cpp \
+    Application/src/Dacumemnt/netlistStore.cpp \
+    Application/src/Dacumemnt/reachIndex.cpp \
+    Application/src/Dacumemnt/slotMap.cpp \
+    Application/src/Dacumemnt/topoOrder.cpp
+
+# Header files
+HEADERS += \
+    Application/inc/Comand/comand.h \
+    Application/inc/Comand/factory.h \
+    Application/inc/Document/arena.h \
+    Application/inc/Document/changeJournal.h \
+    Application/inc/Document/cowVector.h \
+    Application/inc/Document/document.h \
+    Application/inc/Document/documentBuilder.h \
+    Application/inc/Document/fingerprint.h \
+    Application/inc/Document/gateOrder.h \
+    Application/inc/Document/gets.h \
+    Application/inc/Document/gateType.h \
+    Application/inc/Document/module.h \
+    Application/inc/Document/netlist.h \
+    Application/inc/Document/netlistStore.h \
+    Application/inc/Document/reachIndex.h \
+    Application/inc/Document/smallVector.h \
+    Application/inc/Document/slotMap.h \
+    Application/inc/Document/topoOrder.h